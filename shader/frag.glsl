@@ -1,17 +1,14 @@
 #version 330 core
 #pragma shader_stage(fragment)
 
-in vec2 fragCoords;
+in vec3 fragCoords;
+in vec3 fragCol;
 out vec4 outCol;
-uniform sampler2D tex;
-uniform vec3 col;
-uniform bool isFont;
+uniform sampler2DArray tex;
 
+// Font layers are white with the glyph coverage in alpha, so they are tinted
+// like any other sprite
 void main()
 {
-    if (isFont) {
-	outCol = vec4(texture(tex, fragCoords).r) * vec4(col, 1.0);
-    } else {
-	outCol = texture(tex, fragCoords);
-    }
+    outCol = texture(tex, fragCoords) * vec4(fragCol, 1.0);
 }
@@ -1,12 +1,20 @@
 #version 330 core
 #pragma shader_stage(vertex)
 
-layout (location = 0) in vec2 pos;
-layout (location = 1) in vec2 texCoords;
-out vec2 fragCoords;
+layout (location = 2) in vec4 rect;   // Instance position and size
+layout (location = 3) in vec4 uvRect; // Instance top left and bottom right texture coordinates
+layout (location = 4) in float layer; // Instance texture array layer
+layout (location = 5) in vec3 col;    // Instance tint
+out vec3 fragCoords;
+out vec3 fragCol;
 uniform mat4 proj;
 
 void main() {
-    fragCoords  = texCoords;
-    gl_Position = proj * vec4(pos, 0.0, 1.0);
+    // Triangle strip corners, far edges inclusive like sprite_setPos(),
+    // an empty instance collapses to a point
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 p      = rect.xy + max(rect.zw - 1.0, 0.0) * corner;
+    fragCoords  = vec3(mix(uvRect.xy, uvRect.zw, corner), layer);
+    fragCol     = col;
+    gl_Position = proj * vec4(p, 0.0, 1.0);
 }
@@ -0,0 +1,181 @@
+/*
+ * Tests for the collider types. The sweeps return the collision time in
+ * [0.0, 1.0] of the movement and set the normal, 1.0 means no collision.
+ */
+
+#include <cglm/struct.h> // vec2s
+#include <math.h>        // INFINITY, fmaxf, fminf
+
+#include "collider.h"
+#include "fixed.h"
+
+// Function definitions
+
+// The same test as sprite_sweptAABB() with the box edges ready made
+float collider_sweepBox(const Box* moving, vec2s movement, const Box* target, vec2s* normal)
+{
+    float xInvEntry, yInvEntry; float xInvExit, yInvExit;
+    if (movement.x > 0.0f) {
+        xInvEntry = target->min.x - moving->max.x;
+        xInvExit  = target->max.x - moving->min.x;
+    } else {
+        xInvEntry = target->max.x - moving->min.x;
+        xInvExit  = target->min.x - moving->max.x;
+    }
+
+    if (movement.y > 0.0f) {
+        yInvEntry = target->min.y - moving->max.y;
+        yInvExit  = target->max.y - moving->min.y;
+    } else {
+        yInvEntry = target->max.y - moving->min.y;
+        yInvExit  = target->min.y - moving->max.y;
+    }
+
+    float xEntry = -INFINITY, xExit = INFINITY;
+    float yEntry = -INFINITY, yExit = INFINITY;
+    if (movement.x != 0.0f) {
+        xEntry = xInvEntry / movement.x;
+        xExit  = xInvExit / movement.x;
+    }
+    if (movement.y != 0.0f) {
+        yEntry = yInvEntry / movement.y;
+        yExit  = yInvExit / movement.y;
+    }
+
+    float entryTime = fmaxf(xEntry, yEntry);
+    float exitTime  = fminf(xExit, yExit);
+
+    // No collision if there is no overlap during the movement
+    if (entryTime > exitTime || (xEntry < 0.0f && yEntry < 0.0f) || entryTime > 1.0f) {
+        *normal = (vec2s) {{ 0.0f, 0.0f }};
+        return 1.0f;
+    }
+
+    // Determine the collision normal based on which axis had the later entry
+    if (xEntry > yEntry) {
+        *normal = (vec2s) {{ xInvEntry < 0.0f ? 1.0f : -1.0f, 0.0f }};
+    } else {
+        *normal = (vec2s) {{ 0.0f, yInvEntry < 0.0f ? 1.0f : -1.0f }};
+    }
+    return entryTime;
+}
+
+/* Only the corner of the box furthest into the plane can touch it, so this
+ * is one distance and one divide. A box already in the plane and moving
+ * further in collides straight away. */
+float collider_sweepPlane(const Box* moving, vec2s movement, const Plane* target, vec2s* normal)
+{
+    vec2s n = target->normal;
+    float speed = movement.x * n.x + movement.y * n.y;
+    if (speed >= 0.0f) {
+        *normal = (vec2s) {{ 0.0f, 0.0f }};
+        return 1.0f;
+    }
+
+    vec2s corner = {{ n.x >= 0.0f ? moving->min.x : moving->max.x, n.y >= 0.0f ? moving->min.y : moving->max.y }};
+    float dist   = corner.x * n.x + corner.y * n.y - target->dist;
+    float time   = fmaxf(dist, 0.0f) / -speed;
+    if (time > 1.0f) {
+        *normal = (vec2s) {{ 0.0f, 0.0f }};
+        return 1.0f;
+    }
+
+    *normal = n;
+    return time;
+}
+
+// Overlap on the axis where it is least
+float collider_depthBox(const Box* moving, const Box* target)
+{
+    float x = fminf(moving->max.x - target->min.x, target->max.x - moving->min.x);
+    float y = fminf(moving->max.y - target->min.y, target->max.y - moving->min.y);
+    return fminf(x, y);
+}
+
+float collider_depthPlane(const Box* moving, const Plane* target)
+{
+    vec2s n      = target->normal;
+    vec2s corner = {{ n.x >= 0.0f ? moving->min.x : moving->max.x, n.y >= 0.0f ? moving->min.y : moving->max.y }};
+    return target->dist - (corner.x * n.x + corner.y * n.y);
+}
+
+// Fixed point version of collider_sweepBox() for the deterministic physics
+// build, same tests in the same order but with integer maths.
+fixed collider_sweepBoxFixed(FixVec pos, FixVec size, FixVec movement, FixVec targetPos, FixVec targetSize,
+        FixVec* normal)
+{
+    fixed xInvEntry, yInvEntry; fixed xInvExit, yInvExit;
+    if (movement.x > 0) {
+        xInvEntry = targetPos.x - (pos.x + size.x);
+        xInvExit  = (targetPos.x + targetSize.x) - pos.x;
+    } else {
+        xInvEntry = (targetPos.x + targetSize.x) - pos.x;
+        xInvExit  = targetPos.x - (pos.x + size.x);
+    }
+
+    if (movement.y > 0) {
+        yInvEntry = targetPos.y - (pos.y + size.y);
+        yInvExit  = (targetPos.y + targetSize.y) - pos.y;
+    } else {
+        yInvEntry = (targetPos.y + targetSize.y) - pos.y;
+        yInvExit  = targetPos.y - (pos.y + size.y);
+    }
+
+    fixed xEntry, yEntry;
+    fixed xExit,  yExit;
+
+    if (movement.x == 0) {
+        xEntry = FIX_MIN;
+        xExit  = FIX_MAX;
+    } else {
+        xEntry = fix_div(xInvEntry, movement.x);
+        xExit  = fix_div(xInvExit, movement.x);
+    }
+
+    if (movement.y == 0) {
+        yEntry = FIX_MIN;
+        yExit  = FIX_MAX;
+    } else {
+        yEntry = fix_div(yInvEntry, movement.y);
+        yExit  = fix_div(yInvExit, movement.y);
+    }
+
+    fixed entryTime = xEntry > yEntry ? xEntry : yEntry;
+    fixed exitTime  = xExit  < yExit  ? xExit  : yExit;
+
+    // No collision if there is no overlap during the movement
+    if (entryTime > exitTime || (xEntry < 0 && yEntry < 0) || entryTime > FIX_ONE) {
+        *normal = (FixVec) { 0, 0 };
+        return FIX_ONE;
+    }
+
+    // Determine the collision normal based on which axis had the later entry
+    if (xEntry > yEntry) {
+        *normal = (FixVec) { xInvEntry < 0 ? FIX_ONE : -FIX_ONE, 0 };
+    } else {
+        *normal = (FixVec) { 0, yInvEntry < 0 ? FIX_ONE : -FIX_ONE };
+    }
+    return entryTime;
+}
+
+// Fixed point version of collider_sweepPlane()
+fixed collider_sweepPlaneFixed(FixVec pos, FixVec size, FixVec movement, const Plane* target, FixVec* normal)
+{
+    FixVec n     = fix_vecFromVec2(target->normal);
+    fixed  speed = fix_mul(movement.x, n.x) + fix_mul(movement.y, n.y);
+    if (speed >= 0) {
+        *normal = (FixVec) { 0, 0 };
+        return FIX_ONE;
+    }
+
+    FixVec corner = { n.x >= 0 ? pos.x : pos.x + size.x, n.y >= 0 ? pos.y : pos.y + size.y };
+    fixed  dist   = fix_mul(corner.x, n.x) + fix_mul(corner.y, n.y) - fix_fromFloat(target->dist);
+    fixed  time   = fix_div(dist > 0 ? dist : 0, -speed);
+    if (time > FIX_ONE) {
+        *normal = (FixVec) { 0, 0 };
+        return FIX_ONE;
+    }
+
+    *normal = n;
+    return time;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cglm/struct.h> // vec2s
+
+#include "fixed.h"
+
+// Types
+
+// Axis aligned box, for the ball, paddle and bricks
+typedef struct {
+    vec2s min, max;
+} Box;
+
+// Half-plane, for the walls. Solid where dot(p, normal) < dist, the normal
+// points into the play area.
+typedef struct {
+    vec2s normal;
+    float dist;
+} Plane;
+
+// Macros
+// Swept test of a moving box against any collider, picked at compile time
+#define collider_sweep(moving, movement, target, normal) _Generic((target), \
+        Box*:         collider_sweepBox,   \
+        const Box*:   collider_sweepBox,   \
+        Plane*:       collider_sweepPlane, \
+        const Plane*: collider_sweepPlane  \
+    )(moving, movement, target, normal)
+
+// How far a box is into any collider, zero or less if they don't overlap
+#define collider_depth(moving, target) _Generic((target), \
+        Box*:         collider_depthBox,   \
+        const Box*:   collider_depthBox,   \
+        Plane*:       collider_depthPlane, \
+        const Plane*: collider_depthPlane  \
+    )(moving, target)
+
+// Function prototypes
+float collider_sweepBox(const Box* moving, vec2s movement, const Box* target, vec2s* normal);
+float collider_sweepPlane(const Box* moving, vec2s movement, const Plane* target, vec2s* normal);
+float collider_depthBox(const Box* moving, const Box* target);
+float collider_depthPlane(const Box* moving, const Plane* target);
+fixed collider_sweepBoxFixed(FixVec pos, FixVec size, FixVec movement, FixVec targetPos, FixVec targetSize,
+          FixVec* normal);
+fixed collider_sweepPlaneFixed(FixVec pos, FixVec size, FixVec movement, const Plane* target, FixVec* normal);
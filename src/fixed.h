@@ -0,0 +1,109 @@
+/*
+ * 16.16 fixed point maths for the deterministic physics build
+ * (-DFIXED_PHYSICS). Everything is integer arithmetic so results are
+ * bit-exact whatever the compiler, optimisation level or CPU.
+ */
+
+#pragma once
+
+#include <cglm/struct.h> // vec2s
+#include <stdint.h>      // int32_t, int64_t, uint64_t, INT32_MIN, INT32_MAX
+
+// Types
+typedef int32_t fixed;
+
+typedef struct {
+    fixed x, y;
+} FixVec;
+
+// Constants
+constexpr int   FIX_SHIFT = 16;
+constexpr fixed FIX_ONE   = 1 << FIX_SHIFT;
+constexpr fixed FIX_MIN   = INT32_MIN; // Stands in for -INFINITY
+constexpr fixed FIX_MAX   = INT32_MAX; // Stands in for INFINITY
+
+// Function definitions
+
+// Truncates, scaling by a power of two is exact so this is deterministic
+static inline fixed fix_fromFloat(float f)
+{
+    return (fixed) (f * FIX_ONE);
+}
+
+static inline float fix_toFloat(fixed x)
+{
+    return (float) x / FIX_ONE;
+}
+
+static inline fixed fix_clamp(int64_t x)
+{
+    return x < FIX_MIN ? FIX_MIN : (x > FIX_MAX ? FIX_MAX : (fixed) x);
+}
+
+static inline fixed fix_mul(fixed a, fixed b)
+{
+    return (fixed) (((int64_t) a * b) >> FIX_SHIFT);
+}
+
+// Saturates rather than overflowing, b must not be zero
+static inline fixed fix_div(fixed a, fixed b)
+{
+    return fix_clamp(((int64_t) a * FIX_ONE) / b);
+}
+
+// Bitwise integer square root
+static inline uint64_t fix_isqrt(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit = UINT64_C(1) << 62;
+
+    while (bit > x) bit >>= 2;
+    while (bit) {
+        if (x >= res + bit) {
+            x   -= res + bit;
+            res  = (res >> 1) + bit;
+        } else {
+            res >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    return res;
+}
+
+static inline FixVec fix_vecFromVec2(vec2s v)
+{
+    return (FixVec) { fix_fromFloat(v.x), fix_fromFloat(v.y) };
+}
+
+static inline FixVec fix_vecAdd(FixVec a, FixVec b)
+{
+    return (FixVec) { a.x + b.x, a.y + b.y };
+}
+
+static inline FixVec fix_vecScale(FixVec v, fixed s)
+{
+    return (FixVec) { fix_mul(v.x, s), fix_mul(v.y, s) };
+}
+
+static inline FixVec fix_vecNormalize(FixVec v)
+{
+    // Squares are 32.32 so the root is 16.16
+    uint64_t sq  = (uint64_t) ((int64_t) v.x * v.x) + (uint64_t) ((int64_t) v.y * v.y);
+    fixed    len = (fixed) fix_isqrt(sq);
+    if (len == 0) return v;
+    return (FixVec) { fix_div(v.x, len), fix_div(v.y, len) };
+}
+
+// Reflect v off a surface with normal n
+static inline FixVec fix_vecReflect(FixVec v, FixVec n)
+{
+    fixed dot = fix_mul(v.x, n.x) + fix_mul(v.y, n.y);
+    return (FixVec) { v.x - 2 * fix_mul(dot, n.x), v.y - 2 * fix_mul(dot, n.y) };
+}
+
+// Rotate v by the angle with the given cosine and sine
+static inline FixVec fix_vecRotate(FixVec v, fixed c, fixed s)
+{
+    return (FixVec) { fix_mul(v.x, c) - fix_mul(v.y, s), fix_mul(v.x, s) + fix_mul(v.y, c) };
+}
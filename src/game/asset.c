@@ -1,19 +1,26 @@
+#include <stdio.h>  // printf
 #include <stdlib.h> // atexit
 
+#include "../job.h"
 #include "../main.h"
 #include "../util.h"
+#include "../gfx/atlas.h"
 #include "../gfx/font.h"
 #include "../gfx/gfx.h"
+#include "../gfx/queue.h"
 #include "../gfx/rend.h"
 #include "../gfx/screen.h"
+#include "../gfx/tex.h"
 #include "audio.h"
 #include "asset.h"
 #include "ball.h"
+#include "draw.h"
 #include "game.h"
 #include "hiscore.h"
 #include "level.h"
 #include "paddle.h"
 #include "parallax.h"
+#include "stats.h"
 #include "wall.h"
 
 // Function prototypes
@@ -23,8 +30,6 @@ static void loadBg(void);
 static void unloadBg(void);
 static void loadSpriteRend(void);
 static void unloadSpriteRend(void);
-static void loadFonts(void);
-static void unloadFonts(void);
 
 // Constants
 static const char* FILE_BGS[COUNT] = {
@@ -37,16 +42,15 @@ static const char* FILE_BGS[COUNT] = {
     "gfx/background7.png"
 };
 static const char   FILE_LOADING[] = "gfx/loading.png";
-static const char   SPRITE_SHEET[] = "gfx/spritesheet.png";
-static const size_t SPRITE_COUNT   = 200;
-static const char   FONT_FILE[]    = "font/JupiteroidRegular.ttf";
-static const float  FONT_HEIGHTS[] = { 64.0f, 40.0f };
+static const char   ATLAS[]        = "gfx/atlas.txt";
+static const size_t SPRITE_COUNT   = 4500; // Paddle, lives, text and up to 4096 balls
+static const char*  FONTS[FontSizeCount] = { "large", "medium" }; // Atlas fonts
 
 // Variables
 static Screen loading;
 static Screen bgs[COUNT];
 static Rend   spriteRend;
-static Font   fonts[FontSizeCount];
+static Font*  fonts[FontSizeCount];
 
 // Function definitions
 
@@ -74,28 +78,19 @@ void unloadBg(void)
     }
 }
 
+// Everything but the backgrounds is drawn from the atlas, fonts included
 void loadSpriteRend(void)
 {
-    spriteRend = rend_load(SPRITE_COUNT, SPRITE_SHEET);
-}
-
-void unloadSpriteRend(void)
-{
-    rend_unload(spriteRend);
-}
-
-void loadFonts(void)
-{
+    spriteRend     = rend_create(SPRITE_COUNT);
+    spriteRend.tex = atlas_load(ATLAS);
     for (size_t i = 0; i < FontSizeCount; i++) {
-        fonts[i] = font_load(FONT_HEIGHTS[i], FONT_FILE);
+        fonts[i] = atlas_getFont(FONTS[i]);
     }
 }
 
-void unloadFonts(void)
+void unloadSpriteRend(void)
 {
-    for (size_t i = 0; i < FontSizeCount; i++) {
-        font_unload(fonts[i]);
-    }
+    rend_unload(spriteRend);
 }
 
 // Do the minimum required to get a loading screen
@@ -104,6 +99,9 @@ void asset_loading(void)
     gfx_init();
     atexit(gfx_term);
 
+    queue_init(SPRITE_COUNT);
+    atexit(queue_term);
+
     loadLoading();
     atexit(unloadLoading);
 }
@@ -112,15 +110,15 @@ void asset_load(void)
 {
     util_randomSeed();
 
+    job_init();
+    atexit(job_term);
+
     loadBg();
     atexit(unloadBg);
 
     loadSpriteRend();
     atexit(unloadSpriteRend);
 
-    loadFonts();
-    atexit(unloadFonts);
-
     hiscore_load();
     atexit(hiscore_save);
 
@@ -130,20 +128,28 @@ void asset_load(void)
     paddle_init();
     ball_init();     // Requires paddle_init
     level_load();
+    atexit(level_unload);
     wall_init();
 
     parallax_load(); // Requires paddle_init
     atexit(parallax_unload);
+    atexit(draw_printTimings);
+    printf("Texture memory %.1f MB\n", tex_getTotal() / (1024.0 * 1024.0));
+
+#ifndef NDEBUG
+    atexit(stats_print);
+    atexit(gfx_printStates);
+#endif
 }
 
-Screen asset_getLoading(void)
+Screen* asset_getLoading(void)
 {
-    return loading;
+    return &loading;
 }
 
-Screen asset_getBg(int level)
+Screen* asset_getBg(int level)
 {
-    return bgs[level];
+    return &bgs[level];
 }
 
 Rend* asset_getSpriteRend(void)
@@ -153,5 +159,5 @@ Rend* asset_getSpriteRend(void)
 
 Font* asset_getFont(FontSize size)
 {
-    return &fonts[size];
+    return fonts[size];
 }
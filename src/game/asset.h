@@ -5,9 +5,9 @@
 #include "text.h"
 
 // Function prototypes
-void   asset_loading(void);
-void   asset_load(void);
-Screen asset_getLoading(void);
-Screen asset_getBg(int level);
-Rend*  asset_getSpriteRend(void);
-Font*  asset_getFont(FontSize size);
+void    asset_loading(void);
+void    asset_load(void);
+Screen* asset_getLoading(void);
+Screen* asset_getBg(int level);
+Rend*   asset_getSpriteRend(void);
+Font*   asset_getFont(FontSize size);
@@ -1,29 +1,112 @@
 #include <cglm/struct.h> // vec2s
+#include <math.h>        // fminf, fmaxf, cosf, sinf
 
+#include "../collider.h"
+#include "../job.h"
 #include "../main.h"
 #include "../util.h"
+#include "../gfx/atlas.h"
+#include "../gfx/queue.h"
 #include "../gfx/sprite.h"
 #include "audio.h"
 #include "ball.h"
+#include "draw.h"
 #include "game.h"
 #include "paddle.h"
 #include "level.h"
+#include "stats.h"
+#include "trace.h"
 #include "wall.h"
 
+// Constants
+constexpr size_t BATCH_MAX      = 64;
+constexpr int    MAX_BALLS      = 4096;
+constexpr int    MAX_CONTACTS   = 32; // Contacts one ball can resolve in a step, bounds the cost
+
+// Types
+
+// Positions and velocities are 16.16 fixed point in the deterministic build
+#ifdef FIXED_PHYSICS
+typedef fixed Real;
+#define TO_REAL(f)  fix_fromFloat(f)
+#define TO_FLOAT(r) fix_toFloat(r)
+#else
+typedef float Real;
+#define TO_REAL(f)  (f)
+#define TO_FLOAT(r) (r)
+#endif
+
+// Candidate bricks packed for the batched swept test
+typedef struct {
+    float  x[BATCH_MAX];
+    float  y[BATCH_MAX];
+    float  w[BATCH_MAX];
+    float  h[BATCH_MAX];
+    int    bricks[BATCH_MAX];
+    size_t count;
+} Batch;
+
+// Pool of balls as a structure of arrays
+typedef struct {
+    Real  x[MAX_BALLS];
+    Real  y[MAX_BALLS];
+    Real  prevX[MAX_BALLS]; // Position at the previous step, for interpolation
+    Real  prevY[MAX_BALLS];
+    Real  velX[MAX_BALLS];
+    Real  velY[MAX_BALLS];
+    Real  debt[MAX_BALLS];  // Fraction of a step carried over from running out of contacts
+    bool  isLost[MAX_BALLS];
+    int   hits[MAX_BALLS][MAX_CONTACTS]; // Breakable bricks hit this step
+    int   hitCount[MAX_BALLS];
+    float clear[MAX_BALLS]; // Distance free of impacts ahead, negative if unknown
+    int   stamp[MAX_BALLS]; // Level stamp when clear was worked out
+    int   count;
+} Balls;
+
 // Function prototypes
 static vec2s getStuckPos(void);
+static bool  isHit(int b, int brick);
+#ifndef FIXED_PHYSICS
+static bool  sweepBatch(const Box* ball, Batch* b, vec2s movement, float* time, vec2s* normal, int* brickHit);
+static bool  isOob(const Box* ball);
+#endif
+static bool  isTunnelled(int b, const Box* ball);
+static void  carry(int b, float time, Stats* s);
+static void  stepBall(int b, double dt, Stats* s);
+static void  stepRange(int first, int last);
+static void  resolve(void);
 
 // Constants
 static const vec2s SIZE          = {{ 24, 24 }};
-static const vec2s TEX_OFFSET    = {{ 528, 0 }};
 // Choose a random release vector for the ball
 static const vec2s RELEASE_VEC[] = { {{ -0.5f, -0.5f }}, {{  0.5f, -0.5f }} };
 static const unsigned SPEED      = 750;  // Pixels per second
+static const float    MARGIN     = 1.0f; // Grow the swept box so touching bricks are found
+static const int      THREAD_MIN = 256;  // Step on the worker threads from this many balls
+static const float    SPREAD     = 0.3f; // Angle in radians between split balls
+static const float    TUNNEL     = 0.01f; // Overlap that counts as tunnelling, allowing for rounding
+static const float    CLEARANCE  = 2.0f; // Keep this far short of a predicted impact
+static const float    DEBT_MAX   = 1.0f; // Most step time carried over, the rest is dropped
+#ifdef STRESS_TEST
+static const int      STRESS_BALLS = 256; // Balls on release in the stress build
+#endif
+#ifdef FIXED_PHYSICS
+// cos(SPREAD) and sin(SPREAD) in 16.16, libm results can differ between platforms
+static const fixed    SPREAD_COS = 62609;
+static const fixed    SPREAD_SIN = 19367;
+#endif
 
 // Variables
 static bool   isStuck;
-static vec2s  vel;
-static Sprite ball;
+static Balls  balls;
+static Sprite sprite;   // Template for rendering, only the position changes
+static double stepTime; // Step time for the balls being stepped
+static bool   isEventDriven = true;
+#ifdef STRESS_TEST
+static float  speedScale = 20.0f;
+#else
+static float  speedScale = 1.0f;
+#endif
 
 // Function definitions
 
@@ -33,50 +116,355 @@ vec2s getStuckPos(void)
     return (vec2s) {{ ps.pos.x + ps.size.s / 2.0f - SIZE.s / 2.0f, ps.pos.y - SIZE.t }};
 }
 
+#ifndef FIXED_PHYSICS
+// Test the batched bricks, keeping the hit if it is earlier than time
+bool sweepBatch(const Box* ball, Batch* b, vec2s movement, float* time, vec2s* normal, int* brickHit)
+{
+    Boxes targets = { b->x, b->y, b->w, b->h, b->count };
+    b->count = 0;
+
+    float t;
+    vec2s n;
+    int hit = sprite_sweptAABBBatch(ball, movement, targets, &t, &n);
+    if (hit < 0 || t >= *time) return false;
+
+    *time     = t;
+    *normal   = n;
+    *brickHit = b->bricks[hit];
+    return true;
+}
+#endif
+
+// Has ball b already hit this brick during the step? Only breakable bricks
+// are recorded, a solid one is still there
+bool isHit(int b, int brick)
+{
+    for (int i = 0; i < balls.hitCount[b]; i++) {
+	if (balls.hits[b][i] == brick) return true;
+    }
+    return false;
+}
+
 void ball_init(void)
 {
-    isStuck = true;
-    ball    = sprite_create(getStuckPos(), SIZE, TEX_OFFSET, (vec2s) {{ SCR_WIDTH, SCR_HEIGHT }} );
+    AtlasRect rect = atlas_get("ball");
+    isStuck     = true;
+    balls.count = 1;
+    sprite      = sprite_create(getStuckPos(), SIZE, rect.uv, rect.layer);
+    balls.x[0]  = balls.prevX[0] = TO_REAL(sprite.pos.x);
+    balls.y[0]  = balls.prevY[0] = TO_REAL(sprite.pos.y);
+    balls.clear[0] = -1.0f;
+    balls.debt[0]  = 0;
 }
 
-void ball_rend(Rend* r)
+// Render between the previous and current step by alpha
+void ball_rend(Rend* r, float alpha)
 {
-    rend_sprite(r, ball);
+    for (int b = 0; b < balls.count; b++) {
+	float x = TO_FLOAT(balls.prevX[b]) + TO_FLOAT(balls.x[b] - balls.prevX[b]) * alpha;
+	float y = TO_FLOAT(balls.prevY[b]) + TO_FLOAT(balls.y[b] - balls.prevY[b]) * alpha;
+	sprite_setPos(&sprite, (vec2s) {{ x, y }});
+	queue_sprite(LayerSprites, r, &sprite);
+    }
 }
 
+// A stuck ball follows the paddle at the frame rate, so skip interpolation
 void ball_onPaddleMove(void)
 {
     if (isStuck) {
-	sprite_setPos(&ball, getStuckPos());
+	vec2s pos  = getStuckPos();
+	balls.x[0] = balls.prevX[0] = TO_REAL(pos.x);
+	balls.y[0] = balls.prevY[0] = TO_REAL(pos.y);
     }
 }
 
 void ball_release(void)
 {
     if (isStuck) {
-	vel = RELEASE_VEC[util_randomInt(0, COUNT(RELEASE_VEC) - 1)];
+	vec2s vel = RELEASE_VEC[util_randomInt(0, COUNT(RELEASE_VEC) - 1)];
+#ifdef FIXED_PHYSICS
+	FixVec v = fix_vecNormalize(fix_vecFromVec2(vel));
+	balls.velX[0] = v.x;
+	balls.velY[0] = v.y;
+#else
 	vel = glms_vec2_normalize(vel);
+	balls.velX[0] = vel.x;
+	balls.velY[0] = vel.y;
+#endif
+	balls.clear[0] = -1.0f;
 	isStuck = false;
+#ifdef STRESS_TEST
+	ball_split(STRESS_BALLS);
+#endif
     }
 }
 
-bool isOob(void)
+// Multi-ball: each ball in play splits into count balls fanned out around it
+void ball_split(int count)
 {
-    return ball.pos.y + ball.size.t >= SCR_HEIGHT;
+    if (isStuck) return;
+
+    int first = balls.count;
+    for (int b = 0; b < first; b++) {
+	for (int i = 1; i < count && balls.count < MAX_BALLS; i++) {
+	    // Alternate either side of the original direction
+	    int n = balls.count++;
+	    balls.x[n]     = balls.x[b];
+	    balls.y[n]     = balls.y[b];
+	    balls.prevX[n] = balls.prevX[b];
+	    balls.prevY[n] = balls.prevY[b];
+	    balls.clear[n] = -1.0f;
+	    balls.debt[n]  = 0;
+#ifdef FIXED_PHYSICS
+	    // Rotate by SPREAD a step at a time
+	    FixVec v = { balls.velX[b], balls.velY[b] };
+	    fixed  s = i % 2 ? SPREAD_SIN : -SPREAD_SIN;
+	    for (int step = 0; step < (i + 1) / 2; step++) v = fix_vecRotate(v, SPREAD_COS, s);
+	    balls.velX[n]  = v.x;
+	    balls.velY[n]  = v.y;
+#else
+	    float angle = SPREAD * ((i + 1) / 2) * (i % 2 ? 1.0f : -1.0f);
+	    float c = cosf(angle);
+	    float s = sinf(angle);
+	    balls.velX[n]  = balls.velX[b] * c - balls.velY[b] * s;
+	    balls.velY[n]  = balls.velX[b] * s + balls.velY[b] * c;
+#endif
+	}
+    }
 }
 
-void ball_move(double frameTime)
+int ball_getCount(void)
 {
-    if (isStuck) return;
+    return balls.count;
+}
+
+// Predict the path of ball b, false if it hasn't been released yet
+bool ball_trace(int b, int bounces, Trace* t)
+{
+    if (isStuck || b >= balls.count) return false;
+
+    vec2s pos  = {{ TO_FLOAT(balls.x[b]), TO_FLOAT(balls.y[b]) }};
+    Box   ball = { pos, glms_vec2_add(pos, SIZE) };
+    vec2s vel  = {{ TO_FLOAT(balls.velX[b]), TO_FLOAT(balls.velY[b]) }};
+    trace_predict(&ball, vel, bounces, t);
+    return true;
+}
+
+/* A ball left inside a collider at the end of a step has tunnelled into it.
+ * Breakable bricks the ball hit this step are gone, a fast ball can be back
+ * over them before the step ends. */
+bool isTunnelled(int b, const Box* ball)
+{
+    if (collider_depth(ball, paddle_getBox()) > TUNNEL) return true;
+    for (Wall i = 0; i < WallCount; i++) {
+	if (collider_depth(ball, wall_getPlane(i)) > TUNNEL) return true;
+    }
+
+    int   found[QUERY_MAX];
+    int   count = level_query(ball->min, ball->max, found, QUERY_MAX);
+    vec2s size  = level_getBrickSize();
+    for (int k = 0; k < count; k++) {
+	if (isHit(b, found[k])) continue;
+
+	vec2s pos   = level_getBrickPos(found[k]);
+	Box   brick = { pos, glms_vec2_add(pos, size) };
+	if (collider_depth(ball, &brick) > TUNNEL) return true;
+    }
+    return false;
+}
 
-    float remainingTime = 1.0f;   // Represents the fraction of the frame left to move.
-    const int MAX_ITERATIONS = 4; // Prevent infinite loops with multiple collisions.
-    int iter = 0;
+/* Fallback for a step that runs out of contacts: the ball stops where it is
+ * and the time left is moved in the next step, so a ball in a tight corner
+ * falls behind for a step or two instead of losing the time. At most
+ * DEBT_MAX of a step is carried, past that the time is dropped, so a step
+ * never costs more than MAX_CONTACTS contacts whatever the speed. */
+void carry(int b, float time, Stats* s)
+{
+    s->counts[StatBudgets]++;
+    if (time > DEBT_MAX) {
+	time = DEBT_MAX;
+	s->counts[StatDrops]++;
+    }
+    balls.debt[b] = TO_REAL(time);
+}
+
+#ifdef FIXED_PHYSICS
+/* The same step as below in 16.16 fixed point, so the result is bit-exact on
+ * every machine. Colliders are converted from the float sprites, which hold
+ * whole pixels, so the conversion is exact. */
+void stepBall(int b, double dt, Stats* s)
+{
+    FixVec pos  = { balls.x[b], balls.y[b] };
+    FixVec size = fix_vecFromVec2(SIZE);
+    FixVec vel  = { balls.velX[b], balls.velY[b] };
+    balls.prevX[b]    = balls.x[b];
+    balls.prevY[b]    = balls.y[b];
+    balls.isLost[b]   = false;
+    balls.hitCount[b] = 0;
+    s->counts[StatSteps]++;
 
-    // Continue moving until we've used the full frame time or hit the iteration limit.
-    while (remainingTime > 0.0f && iter < MAX_ITERATIONS) {
-	// Calculate the full movement vector for the remaining frame time.
-	vec2s movement = glms_vec2_scale(vel, SPEED * frameTime * remainingTime);
+    fixed speed         = fix_fromFloat((float) (SPEED * speedScale * dt)); // Pixels per step
+    fixed remainingTime = FIX_ONE + balls.debt[b];
+    int contacts = 0;
+    balls.debt[b] = 0;
+
+    while (remainingTime > 0) {
+	if (contacts == MAX_CONTACTS) {
+	    carry(b, TO_FLOAT(remainingTime), s);
+	    break;
+	}
+	FixVec movement = fix_vecScale(vel, fix_mul(speed, remainingTime));
+	s->counts[StatIterations]++;
+	s->counts[StatSweeps] += 1 + WallCount;
+
+	fixed  earliestCollisionTime = FIX_ONE;
+	FixVec collisionNormal = { 0, 0 };
+
+	// Paddle.
+	const Box* pb     = paddle_getBox();
+	FixVec paddlePos  = fix_vecFromVec2(pb->min);
+	FixVec paddleSize = fix_vecFromVec2(glms_vec2_sub(pb->max, pb->min));
+	FixVec tempNormal;
+	bool paddleHit = false;
+	fixed t = collider_sweepBoxFixed(pos, size, movement, paddlePos, paddleSize, &tempNormal);
+	if (t < earliestCollisionTime) {
+	    earliestCollisionTime = t;
+	    collisionNormal = tempNormal;
+	    paddleHit = true;
+	}
+	// Walls.
+	for (Wall i = 0; i < WallCount; i++)
+	{
+	    t = collider_sweepPlaneFixed(pos, size, movement, wall_getPlane(i), &tempNormal);
+	    if (t < earliestCollisionTime) {
+		earliestCollisionTime = t;
+		collisionNormal = tempNormal;
+		paddleHit = false;
+	    }
+	}
+	// Bricks, the broadphase only picks candidates so float is fine there.
+	int brickHit = -1;
+	vec2s sweptMin = {{
+	    fix_toFloat(MIN(pos.x, pos.x + movement.x)) - MARGIN,
+	    fix_toFloat(MIN(pos.y, pos.y + movement.y)) - MARGIN
+	}};
+	vec2s sweptMax = {{
+	    fix_toFloat(MAX(pos.x, pos.x + movement.x) + size.x) + MARGIN,
+	    fix_toFloat(MAX(pos.y, pos.y + movement.y) + size.y) + MARGIN
+	}};
+	int    found[QUERY_MAX];
+	int    count     = level_query(sweptMin, sweptMax, found, QUERY_MAX);
+	FixVec brickSize = fix_vecFromVec2(level_getBrickSize());
+	for (int k = 0; k < count; k++) {
+	    int i = found[k];
+	    if (isHit(b, i)) continue;
+
+	    s->counts[StatSweeps]++;
+	    t = collider_sweepBoxFixed(pos, size, movement, fix_vecFromVec2(level_getBrickPos(i)),
+		    brickSize, &tempNormal);
+	    if (t < earliestCollisionTime) {
+		earliestCollisionTime = t;
+		collisionNormal = tempNormal;
+		paddleHit = false;
+		brickHit  = i;
+	    }
+	}
+
+	// Move the ball up to the collision point.
+	pos = fix_vecAdd(pos, fix_vecScale(movement, earliestCollisionTime));
+
+	// If ball is OOB then it is removed by resolve().
+	if (pos.y + size.y >= SCR_HEIGHT * FIX_ONE) {
+	    balls.isLost[b] = true;
+	    break;
+	}
+
+	if (earliestCollisionTime == FIX_ONE) break;
+
+	vel = fix_vecReflect(vel, collisionNormal);
+
+	if (paddleHit && vel.y < 0) {
+	    fixed paddleCenter = paddlePos.x + paddleSize.x / 2;
+	    fixed hitOffset    = (pos.x + size.x / 2) - paddleCenter;
+	    vel.x = fix_div(hitOffset, paddleSize.x / 2);
+	    vel   = fix_vecNormalize(vel);
+	}
+
+	// Solid bricks stay, so they are not skipped if the ball comes back to them
+	if (brickHit > -1 && !level_isSolid(brickHit)) balls.hits[b][balls.hitCount[b]++] = brickHit;
+
+	remainingTime = fix_mul(remainingTime, FIX_ONE - earliestCollisionTime);
+	contacts++;
+    }
+
+    if (!balls.isLost[b]) {
+	vec2s p   = {{ fix_toFloat(pos.x), fix_toFloat(pos.y) }};
+	Box   box = { p, glms_vec2_add(p, SIZE) };
+	if (isTunnelled(b, &box)) s->counts[StatTunnels]++;
+    }
+
+    balls.x[b]    = pos.x;
+    balls.y[b]    = pos.y;
+    balls.velX[b] = vel.x;
+    balls.velY[b] = vel.y;
+}
+#else
+bool isOob(const Box* ball)
+{
+    return ball->max.y >= SCR_HEIGHT;
+}
+
+/* Step one ball by dt. The level is only read here, bricks hit are recorded
+ * and destroyed afterwards by resolve(), so the balls can be stepped in any
+ * order, or in parallel, with the same result. */
+void stepBall(int b, double dt, Stats* s)
+{
+    vec2s pos  = {{ balls.x[b], balls.y[b] }};
+    Box   ball = { pos, glms_vec2_add(pos, SIZE) };
+    vec2s vel  = {{ balls.velX[b], balls.velY[b] }};
+    balls.prevX[b]    = balls.x[b];
+    balls.prevY[b]    = balls.y[b];
+    balls.isLost[b]   = false;
+    balls.hitCount[b] = 0;
+    s->counts[StatSteps]++;
+
+    /* Event driven: the distance to the next impact is worked out once per
+     * bounce, until then a step is only a move. Destroyed bricks can only
+     * make the impact later, so the prediction holds until a new level, but
+     * moving blocks need the full test every step. This gives the same
+     * result as the full step, which takes over near the impact. */
+    float speed = SPEED * speedScale * dt; // Pixels per step
+    if (isEventDriven && !level_hasMovers() && balls.debt[b] == 0.0f) {
+	if (balls.clear[b] < 0.0f || balls.stamp[b] != level_getStamp()) {
+	    balls.clear[b] = trace_getClearance(&ball, vel);
+	    balls.stamp[b] = level_getStamp();
+	    s->counts[StatPredicts]++;
+	}
+	if (speed + CLEARANCE < balls.clear[b]) {
+	    vec2s movement = glms_vec2_scale(vel, speed * 1.0f);
+	    balls.x[b]      = ball.min.x + movement.x;
+	    balls.y[b]      = ball.min.y + movement.y;
+	    balls.clear[b] -= speed;
+	    return;
+	}
+    }
+    balls.clear[b] = -1.0f;
+
+    float remainingTime = 1.0f + balls.debt[b]; // Represents the fraction of the step left to move.
+    int contacts = 0;
+    balls.debt[b] = 0.0f;
+
+    // Continue moving until we've used the full step time or the contact budget.
+    while (remainingTime > 0.0f) {
+	if (contacts == MAX_CONTACTS) {
+	    carry(b, remainingTime, s);
+	    break;
+	}
+
+	// Calculate the full movement vector for the remaining step time.
+	vec2s movement = glms_vec2_scale(vel, speed * remainingTime);
+	s->counts[StatIterations]++;
+	s->counts[StatSweeps] += 1 + WallCount;
 
 	float earliestCollisionTime = 1.0f;
 	vec2s collisionNormal = {{0, 0}};
@@ -84,7 +472,7 @@ void ball_move(double frameTime)
 	// Check collision with the paddle.
 	vec2s tempNormal;
 	bool paddleHit = false;
-	float t = sprite_sweptAABB(ball, movement, paddle_getSprite(), &tempNormal);
+	float t = collider_sweep(&ball, movement, paddle_getBox(), &tempNormal);
 	if (t < earliestCollisionTime) {
 	    earliestCollisionTime = t;
 	    collisionNormal = tempNormal;
@@ -93,41 +481,60 @@ void ball_move(double frameTime)
 	// Walls.
 	for (Wall i = 0; i < WallCount; i++)
 	{
-	    t = sprite_sweptAABB(ball, movement, wall_getSprite(i), &tempNormal);
+	    t = collider_sweep(&ball, movement, wall_getPlane(i), &tempNormal);
 	    if (t < earliestCollisionTime) {
 		earliestCollisionTime = t;
 		collisionNormal = tempNormal;
 		paddleHit = false;
 	    }
 	}
-	// Bricks.
+	// Bricks, only those the broadphase finds near the swept box, tested
+	// in batches. Bricks this ball already hit stay in the level until
+	// resolve() so are skipped.
 	int brickHit = -1;
-	for (int i = 0; i < level_getBrickCount(); i++) {
-	    Sprite* brick = level_getBrickSprite(i);
-	    if (brick) {
-		t = sprite_sweptAABB(ball, movement, *brick, &tempNormal);
-		if (t < earliestCollisionTime) {
-		    earliestCollisionTime = t;
-		    collisionNormal = tempNormal;
-		    brickHit = i;
-		    paddleHit = false;
-		}
+	vec2s sweptMin = {{
+	    fminf(ball.min.x, ball.min.x + movement.x) - MARGIN,
+	    fminf(ball.min.y, ball.min.y + movement.y) - MARGIN
+	}};
+	vec2s sweptMax = {{
+	    fmaxf(ball.max.x, ball.max.x + movement.x) + MARGIN,
+	    fmaxf(ball.max.y, ball.max.y + movement.y) + MARGIN
+	}};
+	int   found[QUERY_MAX];
+	int   count = level_query(sweptMin, sweptMax, found, QUERY_MAX);
+	vec2s size  = level_getBrickSize();
+	Batch batch;
+	batch.count = 0;
+	for (int k = 0; k < count; k++) {
+	    int i = found[k];
+	    if (isHit(b, i)) continue;
+
+	    s->counts[StatSweeps]++;
+	    vec2s brickPos = level_getBrickPos(i);
+	    batch.x[batch.count]      = brickPos.x;
+	    batch.y[batch.count]      = brickPos.y;
+	    batch.w[batch.count]      = size.s;
+	    batch.h[batch.count]      = size.t;
+	    batch.bricks[batch.count] = i;
+	    if (++batch.count == BATCH_MAX &&
+		    sweepBatch(&ball, &batch, movement, &earliestCollisionTime, &collisionNormal, &brickHit)) {
+		paddleHit = false;
 	    }
 	}
+	if (batch.count > 0 &&
+		sweepBatch(&ball, &batch, movement, &earliestCollisionTime, &collisionNormal, &brickHit)) {
+	    paddleHit = false;
+	}
 
 	// Move the ball up to the collision point.
 	vec2s movePart = glms_vec2_scale(movement, earliestCollisionTime);
-	sprite_setPos(&ball, glms_vec2_add(ball.pos, movePart));
-
-	// If ball is OOB then lose a life and check for game over.
-	if (isOob()) {
-	    ball_init();
-	    if (paddle_lifeLost()) {
-		audio_playSound(SoundDeath);
-	    } else {
-		game_lost();
-		return;
-	    }
+	ball.min = glms_vec2_add(ball.min, movePart);
+	ball.max = glms_vec2_add(ball.min, SIZE);
+
+	// If ball is OOB then it is removed by resolve().
+	if (isOob(&ball)) {
+	    balls.isLost[b] = true;
+	    break;
 	}
 
 	// If no collision occurred during this movement, we're done.
@@ -138,18 +545,116 @@ void ball_move(double frameTime)
 
 	// Modify X velocity based on where it hit the paddle, unless it bounced off the side.
 	if (paddleHit && vel.y < 0.0f) {
-	    Sprite paddle = paddle_getSprite();
-	    float paddleCenter = paddle.pos.x + paddle.size.x / 2.0f;
-	    float hitOffset    = (ball.pos.x + ball.size.x / 2.0f) - paddleCenter;
-	    vel.x = hitOffset / (paddle.size.x / 2.0f);
+	    const Box* paddle = paddle_getBox();
+	    float paddleHalf   = (paddle->max.x - paddle->min.x) / 2.0f;
+	    float paddleCenter = paddle->min.x + paddleHalf;
+	    float hitOffset    = (ball.min.x + SIZE.s / 2.0f) - paddleCenter;
+	    vel.x = hitOffset / paddleHalf;
 	    vel   = glms_vec2_normalize(vel);
 	}
 
-	// If collision was with a brick then destroy it.
-	if (brickHit > -1) level_destroyBrick(brickHit);
+	// If collision was with a brick then record it.
+	// Solid bricks stay, so they are not skipped if the ball comes back to them
+	if (brickHit > -1 && !level_isSolid(brickHit)) balls.hits[b][balls.hitCount[b]++] = brickHit;
 
-	// Deduct the used portion of the frame time.
+	// Deduct the used portion of the step time.
 	remainingTime *= (1.0f - earliestCollisionTime);
-	iter++;
+	contacts++;
     }
+
+    if (!balls.isLost[b] && isTunnelled(b, &ball)) s->counts[StatTunnels]++;
+
+    balls.x[b]    = ball.min.x;
+    balls.y[b]    = ball.min.y;
+    balls.velX[b] = vel.x;
+    balls.velY[b] = vel.y;
+}
+#endif
+
+// Counts are added up per slice so the threads only share them once
+void stepRange(int first, int last)
+{
+    Stats s = {};
+    for (int b = first; b < last; b++) stepBall(b, stepTime, &s);
+    stats_add(&s);
+}
+
+/* Apply the results of the step in ball order. Every ball that hit a brick
+ * bounced off it, but a brick hit by several balls in one step is destroyed
+ * and scored once, for the lowest numbered ball. */
+void resolve(void)
+{
+    for (int b = 0; b < balls.count; b++) {
+	for (int i = 0; i < balls.hitCount[b]; i++) {
+	    level_destroyBrick(balls.hits[b][i]);
+	}
+    }
+
+    // Remove lost balls, keeping the order of the rest
+    int count = 0;
+    for (int b = 0; b < balls.count; b++) {
+	if (balls.isLost[b]) continue;
+	balls.x[count]     = balls.x[b];
+	balls.y[count]     = balls.y[b];
+	balls.prevX[count] = balls.prevX[b];
+	balls.prevY[count] = balls.prevY[b];
+	balls.clear[count] = balls.clear[b];
+	balls.stamp[count] = balls.stamp[b];
+	balls.debt[count]  = balls.debt[b];
+	balls.velX[count]  = balls.velX[b];
+	balls.velY[count]  = balls.velY[b];
+	count++;
+    }
+    balls.count = count;
+
+    // Lose a life once the last ball is gone and check for game over.
+    if (count == 0) {
+	ball_init();
+	if (paddle_lifeLost()) {
+	    audio_playSound(SoundDeath);
+	} else {
+	    game_lost();
+	}
+    }
+}
+
+void ball_setEventDriven(bool isOn)
+{
+    isEventDriven = isOn;
+}
+
+// Always stepped in full in the fixed point build
+bool ball_isEventDriven(void)
+{
+#ifdef FIXED_PHYSICS
+    return false;
+#else
+    return isEventDriven;
+#endif
+}
+
+/* Multiply the ball speed, for speed-up modifiers. The swept tests hold at
+ * any speed, it only changes how many contacts a step can meet. */
+void ball_setSpeedScale(float scale)
+{
+    speedScale = scale;
+}
+
+float ball_getSpeedScale(void)
+{
+    return speedScale;
+}
+
+void ball_move(double dt)
+{
+    if (isStuck) return;
+
+    stepTime = dt;
+    if (balls.count >= THREAD_MIN && job_getWorkerCount() > 0) {
+	job_parallelFor(balls.count, stepRange);
+    } else {
+	stepRange(0, balls.count);
+    }
+
+    resolve();
 }
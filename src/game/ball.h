@@ -1,10 +1,18 @@
 #pragma once
 
 #include "../gfx/rend.h"
+#include "trace.h"
 
 // Function prototypes
-void ball_init(void);
-void ball_rend(Rend* r);
-void ball_onPaddleMove(void);
-void ball_release(void);
-void ball_move(double frameTime);
+void  ball_init(void);
+void  ball_rend(Rend* r, float alpha);
+void  ball_onPaddleMove(void);
+void  ball_release(void);
+void  ball_split(int count);
+int   ball_getCount(void);
+bool  ball_trace(int b, int bounces, Trace* t);
+void  ball_move(double dt);
+void  ball_setEventDriven(bool isOn);
+bool  ball_isEventDriven(void);
+void  ball_setSpeedScale(float scale);
+float ball_getSpeedScale(void);
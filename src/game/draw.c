@@ -1,9 +1,12 @@
 #include <cglm/struct.h> // vec3s
+#include <stdio.h>       // printf, snprintf
 
-#include "../gfx/gfx.h"
+#include "../gfx/queue.h"
 #include "../gfx/screen.h"
+#include "../gfx/timer.h"
 #include "asset.h"
 #include "ball.h"
+#include "draw.h"
 #include "game.h"
 #include "hiscore.h"
 #include "level.h"
@@ -13,6 +16,9 @@
 
 // Function prototypes
 static void drawGame(void);
+#ifndef NDEBUG
+static void drawTimings(void);
+#endif
 
 // Constants
 static const vec3s BLACK = {{ 0.0f, 0.0f, 0.0f }};
@@ -38,22 +44,26 @@ static const Text TEXT_MENU =
     "\n"
     "Click mouse button to continue."
 };
+static const char* LAYER_NAMES[LayerCount] = { "Stars", "Background", "Bricks", "Sprites", "Text" };
+#ifndef NDEBUG
+static const Text  TEXT_TIMINGS = { FontMedium, {{ 40, 150 }}, {{ 0.2f, 1.0f, 0.2f }}, "%s" };
+
+// Variables
+static bool isTimings = false;
+#endif
 
 // Function definitions
 
 void drawGame(void)
 {
-    gfx_clear(BLACK);
+    queue_clear(BLACK);
+    Rend* r = asset_getSpriteRend();
     parallax_rend();
     int level = level_getCurrent();
-    screen_rend(asset_getBg(level));
-
-    Rend* r = asset_getSpriteRend();
-    rend_begin(*r);
-    level_rend(r);
+    screen_rend(asset_getBg(level), LayerBg);
+    level_rend(r, game_getAlpha());
     paddle_rend(r);
-    ball_rend(r);
-    rend_end(r);
+    ball_rend(r, game_getAlpha());
 
     int score   = paddle_getScore();
     int hiscore = hiscore_getHi();
@@ -62,47 +72,78 @@ void drawGame(void)
     text_rend(TEXT_SCORE2, score);
     text_rend(TEXT_LEVEL2, level, COUNT);
     text_rend(TEXT_HISCORE2, hiscore);
-    // Need to flush to change colour
-    text_flush();
     // Normal text
     text_rend(TEXT_SCORE, score);
     text_rend(TEXT_LEVEL, level, COUNT);
     text_rend(TEXT_HISCORE, hiscore);
 }
 
+#ifndef NDEBUG
+
+void draw_toggleTimings(void)
+{
+    isTimings = !isTimings;
+}
+
+// A pass whose draws merged with the layer before it is timed with that layer
+void drawTimings(void)
+{
+    Timings t     = timer_get();
+    double  total = 0.0;
+    char    lines[256];
+    int     len   = snprintf(lines, sizeof lines, "%s ms per frame\n", t.isGpu ? "GPU" : "CPU submit");
+    for (int i = 0; i < LayerCount; i++) {
+	len   += snprintf(lines + len, sizeof lines - len, "%s %.2f\n", LAYER_NAMES[i], t.ms[i]);
+	total += t.ms[i];
+    }
+    snprintf(lines + len, sizeof lines - len, "Total %.2f", total);
+    text_rend(TEXT_TIMINGS, lines);
+}
+
+#endif // !NDEBUG
+
+void draw_printTimings(void)
+{
+    Timings t = timer_getSession();
+    printf("%s time per frame\n", t.isGpu ? "GPU" : "CPU submit");
+    for (int i = 0; i < LayerCount; i++) {
+	printf("%-18s %12.3f ms\n", LAYER_NAMES[i], t.ms[i]);
+    }
+}
+
+/* Queue everything for the frame, to be drawn in layers by whoever takes it
+ * after render_frame() */
 void draw_frame(void)
 {
     switch (game_getState()) {
         case StateLoading:
-            screen_rend(asset_getLoading());
+            screen_rend(asset_getLoading(), LayerBg);
             break;
         case StateMenu:
-            screen_rend(asset_getLoading());
+            screen_rend(asset_getLoading(), LayerBg);
 	    text_rend(TEXT_MENU);
-	    text_flush();
             break;
         case StatePause:
             drawGame();
 	    text_rend(TEXT_PAUSED);
-	    text_flush();
             break;
         case StateRun:
             drawGame();
-	    text_flush();
             break;
         case StateWon:
             drawGame();
             text_rend(TEXT_WON);
             if (hiscore_isHi()) text_rend(TEXT_NEWHISCORE);
             text_rend(TEXT_CONTINUE);
-	    text_flush();
             break;
         case StateLost:
 	    drawGame();
             text_rend(TEXT_LOST);
             if (hiscore_isHi()) text_rend(TEXT_NEWHISCORE);
             text_rend(TEXT_CONTINUE);
-	    text_flush();
             break;
     }
+#ifndef NDEBUG
+    if (isTimings) drawTimings();
+#endif
 }
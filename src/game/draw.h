@@ -1,4 +1,20 @@
 #pragma once
 
+// Types
+
+// Draw order of the render queue, sprites of one layer can be drawn in any order
+typedef enum {
+    LayerStars,
+    LayerBg,
+    LayerBricks,
+    LayerSprites,
+    LayerText,
+    LayerCount
+} DrawLayer;
+
 // Function prototypes
+#ifndef NDEBUG
+void draw_toggleTimings(void);
+#endif
+void draw_printTimings(void);
 void draw_frame(void);
@@ -1,3 +1,5 @@
+#include <math.h> // fmod
+
 #include "../main.h"
 #include "audio.h"
 #include "ball.h"
@@ -6,15 +8,24 @@
 #include "input.h"
 #include "level.h"
 #include "paddle.h"
+#include "stats.h"
 
 // Function prototypes
 static void resetGame(void);
 static void startGame(void);
 static void gameWon(void);
 static void levelClear(void);
+static void tick(double dt);
+
+// Constants
+static const double TICK_RATE = 240.0; // Default simulation steps per second
+static const int    MAX_STEPS = 8;     // Most steps per frame, the rest of a long frame is dropped
 
 // Variables
-static State state = StateLoading;
+static State  state       = StateLoading;
+static double tickRate    = TICK_RATE;
+static double accumulator = 0.0;  // Frame time not yet simulated
+static float  alpha       = 1.0f; // How far between the last two steps to render
 
 // Function definitions
 
@@ -134,6 +145,19 @@ void levelClear(void)
     audio_playMusic(level_getCurrent());
 }
 
+void tick(double dt)
+{
+    ball_move(dt);
+    level_update(dt);
+
+    if (level_isClear()) {
+	if (level_next()) levelClear(); else gameWon();
+    }
+}
+
+/* Fixed time step: the simulation always advances by whole ticks so it runs
+ * the same at any refresh rate, rendering interpolates between the last two
+ * ticks. */
 void game_update(double frameTime)
 {
     switch (state) {
@@ -142,16 +166,36 @@ void game_update(double frameTime)
 	case StatePause:
 	case StateWon:
 	case StateLost:
+	    accumulator = 0.0;
 	    break;
 	case StateRun:
-	    ball_move(frameTime);
-
-	    if (level_isClear()) {
-		if (level_next()) levelClear(); else gameWon();
+	    double dt = 1.0 / tickRate;
+	    accumulator += frameTime;
+
+	    int steps = 0;
+	    while (accumulator >= dt && steps < MAX_STEPS && state == StateRun) {
+		tick(dt);
+		accumulator -= dt;
+		steps++;
 	    }
+	    // Drop the time we could not catch up on rather than spiral
+	    if (accumulator >= dt) accumulator = fmod(accumulator, dt);
 
+	    alpha = accumulator / dt;
 	    break;
     }
+
+    stats_endFrame();
+}
+
+void game_setTickRate(double rate)
+{
+    tickRate = rate;
+}
+
+float game_getAlpha(void)
+{
+    return alpha;
 }
 
 State game_getState(void)
@@ -18,6 +18,8 @@ void  game_togglePause(void);
 void  game_quit(void);
 void  game_click(void);
 void  game_update(double frameTime);
+void  game_setTickRate(double rate);
+float game_getAlpha(void);
 void  game_render(void);
 State game_getState(void);
 void  game_lost(void);
@@ -3,12 +3,15 @@
 #include <GLFW/glfw3.h> // GLFW*
 
 #include "../main.h"
-#include "../util.h"
 #ifndef NDEBUG
-#include "../gfx/gfx.h"
+#include "../render.h"
 #endif
+#include "../util.h"
 #include "audio.h"
 #include "ball.h"
+#ifndef NDEBUG
+#include "draw.h"
+#endif
 #include "game.h"
 #include "input.h"
 #ifndef NDEBUG
@@ -31,13 +34,22 @@ typedef struct {
 } Button;
 
 // Function declarations
+#ifndef NDEBUG
 static void nextLevel(void);
+static void multiBall(void);
+static void toggleEvents(void);
+static void cycleTurbo(void);
+#endif
 
 // Constants
 static const Key KEYS[] = {
 #ifndef NDEBUG
     { GLFW_KEY_N, (void (*)(void)) nextLevel },
-    { GLFW_KEY_S, gfx_screenshot },
+    { GLFW_KEY_S, render_screenshot },
+    { GLFW_KEY_M, multiBall },
+    { GLFW_KEY_E, toggleEvents },
+    { GLFW_KEY_T, cycleTurbo },
+    { GLFW_KEY_G, draw_toggleTimings },
 #endif
     { GLFW_KEY_SPACE,  game_togglePause },
     { GLFW_KEY_ESCAPE, game_quit }
@@ -55,6 +67,23 @@ void nextLevel(void)
     audio_stopMusic();
     audio_playMusic(level_getCurrent());
 }
+
+void multiBall(void)
+{
+    ball_split(3);
+}
+
+void toggleEvents(void)
+{
+    ball_setEventDriven(!ball_isEventDriven());
+}
+
+// Ball speed 1x, 10x, 20x and back
+void cycleTurbo(void)
+{
+    float scale = ball_getSpeedScale();
+    ball_setSpeedScale(scale < 10.0f ? 10.0f : scale < 20.0f ? 20.0f : 1.0f);
+}
 #endif
 
 void input_keyDown(int key)
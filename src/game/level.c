@@ -1,77 +1,264 @@
-#include <ctype.h> // isdigit
+#include <ctype.h>  // isdigit, isupper
+#include <math.h>   // floorf, ceilf, fmod, sinf
+#include <stdint.h> // uint8_t, int64_t, uint64_t
+#include <stdio.h>  // sscanf
+#include <string.h> // memcpy, memset, memcmp, strcmp
 
 #include "../main.h"
+#include "../fixed.h"
 #include "../util.h"
+#include "../gfx/atlas.h"
+#include "../gfx/queue.h"
 #include "../gfx/rend.h"
 #include "../gfx/sprite.h"
 #include "audio.h"
+#include "draw.h"
 #include "level.h"
 #include "paddle.h"
 #include "wall.h"
 
+// Constants
+constexpr int COLS  = 12;
+constexpr int ROWS  = 24;
+constexpr int CELLS = COLS * ROWS;
+constexpr int BITS  = 64;                        // Bits per word of a bitset
+constexpr int WORDS = (CELLS + BITS - 1) / BITS; // Words per bitset
+constexpr int MAX_MOVERS  = 16; // Moving blocks per level
+constexpr int CELL_MOVERS = 8;  // Moving bricks that can overlap one cell
+constexpr int BLAST_BUDGET = 4; // Explosions per tick, so a long chain spreads out
+constexpr int TYPES = 6;        // Brick colours
+
 // Types
+
+typedef struct {
+    int col1, row1; // Inclusive range of grid cells
+    int col2, row2;
+} Cells;
+
+typedef enum {
+    MotionSwing, // Smoothly back and forth
+    MotionSlide  // Constant speed, turning at the ends
+} Motion;
+
+// A block of the grid that moves as one
+typedef struct {
+    Cells  cells;
+    Motion motion;
+    vec2s  axis;     // Unit vector
+    float  distance; // Pixels either side of the start
+    float  period;   // Seconds for a full cycle
+} Mover;
+
+// One bit or byte per cell, bricks only become sprites when rendered
 typedef struct {
-    bool   isActive;
-    bool   isSolid;
-    bool   isDestroyed;
-    Sprite sprite;
-} Brick;
+    uint64_t isActive[WORDS];
+    uint64_t isSolid[WORDS];
+    uint64_t isExplosive[WORDS];
+    uint64_t isDestroyed[WORDS];
+    uint8_t  type[CELLS];  // Colour, index into the sprite tables
+    uint8_t  mover[CELLS]; // Moving block plus one, zero for a static brick
+    int      remaining;    // Breakable bricks left to destroy
+    Mover    movers[MAX_MOVERS];
+    int      moverCount;
+} Bricks;
+
+// Moving bricks overlapping a cell
+typedef struct {
+    int      count;
+    uint16_t bricks[CELL_MOVERS];
+} CellMovers;
 
 // Function prototypes
-static void  readLevel(int level, const char *data);
-static Brick createBrick(char id, int col, int row);
-static void  updateScore(int i);
+static bool getBit(const uint64_t* bits, int i);
+static void setBit(uint64_t* bits, int i);
+static void addBrick(Bricks* b, char id, int i);
+static void readMover(Bricks* b, const char* line);
+static void markMovers(Bricks* b);
+static void dirtyMovers(void);
+static vec2s getRendPos(int brick, float alpha);
+static void readLevel(int level, const char *data);
+static bool getCells(vec2s min, vec2s max, Cells* c);
+static void coverCells(int brick, Cells* c);
+static void linkBrick(int brick);
+static void unlinkBrick(int brick);
+static void startLevel(void);
+static void explode(void);
+static float getOffset(const Mover* mv);
+static void destroyBrick(int brick);
+static int  getScore(int i);
 
 // Constants
 static const char FOLDER[] = "level";
-constexpr int COLS  = 12;
-constexpr int ROWS  = 24;
 static const vec2s    SIZE = {{ 128, 32 }};
-static const vec2s    NORMAL_OFFSETS[] = {
-    {{ 0,   64 }}, // blue,   id = 0
-    {{ 128, 64 }}, // green,  id = 1
-    {{ 256, 64 }}, // orange, id = 2
-    {{ 0,   96 }}, // purple, id = 3
-    {{ 128, 96 }}, // red,    id = 4
-    {{ 256, 96 }}  // yellow, id = 5
+#ifdef FIXED_PHYSICS
+// sin(TAU/4 * t) ~ t * (SIN_1 + t^2 * (SIN_3 + t^2 * SIN_5)) for t in [-1, 1], in
+// 16.16 and fitted to give exactly one at t = 1, libm results can differ
+// between platforms
+static const fixed    SIN_1 = 102914;
+static const fixed    SIN_3 = -42081;
+static const fixed    SIN_5 = 4703;
+// Offsets are whole 1/256ths of a pixel, so added to a grid position as floats
+// they stay exact and convert back to 16.16 without rounding
+static const fixed    OFFSET_MASK = ~0xff;
+#else
+static const float    TAU  = 6.28318531f;
+#endif
+static const vec3s    WHITE = {{ 1.0f, 1.0f, 1.0f }};
+static const vec3s    BLAST = {{ 1.0f, 0.4f, 0.3f }}; // Tint of explosive bricks, so chains can be seen
+// Atlas sprites by brick type
+static const char*    NORMAL_SPRITES[TYPES] = {
+    "brick_blue",   // id = 0
+    "brick_green",  // id = 1
+    "brick_orange", // id = 2
+    "brick_purple", // id = 3
+    "brick_red",    // id = 4
+    "brick_yellow"  // id = 5
 };
-static const vec2s    SOLID_OFFSETS[] = {
-    {{ 0,   0 }},  // blue,   id = a
-    {{ 128, 0 }},  // green,  id = b
-    {{ 256, 0 }},  // orange, id = c
-    {{ 0,   32 }}, // purple, id = d
-    {{ 128, 32 }}, // red,    id = e
-    {{ 256, 32 }}, // yellow, id = f
+static const char*    SOLID_SPRITES[TYPES] = {
+    "solid_blue",   // id = a
+    "solid_green",  // id = b
+    "solid_orange", // id = c
+    "solid_purple", // id = d
+    "solid_red",    // id = e
+    "solid_yellow"  // id = f
 };
 
 // Variables
-static Brick levels[COUNT][COLS * ROWS];
+static Bricks levels[COUNT]; // Each level as loaded, copied from on reset
+static Bricks bricks;        // The level being played
 static int level;
+#ifdef FIXED_PHYSICS
+static int64_t    moveTime;              // Time since the level started, 16.16 seconds
+#else
+static double     moveTime;              // Time since the level started
+#endif
+static vec2s      offsets[MAX_MOVERS];   // Current offset of each moving block
+static vec2s      prevOffsets[MAX_MOVERS]; // Offset of each moving block a step before
+static float      rendAlpha;             // Alpha the moving bricks were last drawn at
+static Cells      covers[CELLS];         // Cells overlapped by each moving brick
+static CellMovers cellMovers[CELLS];     // Moving bricks in each cell, static bricks use the bitsets
+static int        blasts[CELLS];         // Queue of explosive bricks waiting to go off
+static int        blastHead, blastTail;
+static int        pendingScore;          // Score and bricks destroyed this tick, given out
+static int        pendingCount;          // once by level_update()
+static int        stamp;                 // Changes with each new level
+static Slots      slots;                 // Brick sprites on the GPU, one slot per cell
+static uint64_t   isDirty[WORDS];        // Slots to update before the next draw
+static AtlasRect  normalRects[TYPES];    // Atlas sprites by brick type
+static AtlasRect  solidRects[TYPES];
 
 // Function definitions
 
-Brick createBrick(char id, int col, int row)
+bool getBit(const uint64_t* bits, int i)
+{
+    return bits[i / BITS] & (UINT64_C(1) << (i % BITS));
+}
+
+void setBit(uint64_t* bits, int i)
+{
+    bits[i / BITS] |= UINT64_C(1) << (i % BITS);
+}
+
+void addBrick(Bricks* b, char id, int i)
 {
-    Brick b;
+    setBit(b->isActive, i);
+    if (isdigit(id)) {
+        b->type[i] = id - '0';
+        b->remaining++;
+    } else if (isupper(id)) {
+        setBit(b->isExplosive, i);
+        b->type[i] = id - 'A';
+        b->remaining++;
+    } else {
+        setBit(b->isSolid, i);
+        b->type[i] = id - 'a';
+    }
+}
 
-    bool isSolid = !isdigit(id);
+/* Moving block: @ col row width height motion axis distance seconds
+ * motion is swing or slide, axis is x or y. */
+void readMover(Bricks* b, const char* line)
+{
+    Cells c;
+    int   width, height;
+    char  motion[8];
+    char  axis;
+    float distance, period;
+    if (sscanf(line, "%d %d %d %d %7s %c %f %f", &c.col1, &c.row1, &width, &height, motion, &axis,
+                &distance, &period) != 8) {
+        main_term(EXIT_FAILURE, "Syntax error in level file.\n");
+    }
+    if (b->moverCount == MAX_MOVERS) {
+        main_term(EXIT_FAILURE, "Too many moving blocks in level file.\n");
+    }
 
-    b.isActive    = true;
-    b.isSolid     = isSolid;
-    b.isDestroyed = false;
+    Mover* m = &b->movers[b->moverCount++];
+    c.col2 = c.col1 + width - 1;
+    c.row2 = c.row1 + height - 1;
+    m->cells    = c;
+    m->distance = distance;
+    m->period   = period;
 
-    vec2s pos    = {{ WALL_LEFT + col * SIZE.s, WALL_TOP + row * SIZE.t }};
-    vec2s offset = isSolid ? SOLID_OFFSETS[id - 'a'] : NORMAL_OFFSETS[id - '0'];
-    b.sprite     = sprite_create(pos, SIZE, offset, (vec2s) {{ SCR_WIDTH, SCR_HEIGHT }});
+    if (strcmp(motion, "swing") == 0) {
+        m->motion = MotionSwing;
+    } else if (strcmp(motion, "slide") == 0) {
+        m->motion = MotionSlide;
+    } else {
+        main_term(EXIT_FAILURE, "Syntax error in level file.\n");
+    }
 
-    return b;
+    // The block must stay in the grid
+    float room1, room2;
+    if (axis == 'x') {
+        m->axis = (vec2s) {{ 1, 0 }};
+        room1   = c.col1 * SIZE.s;
+        room2   = (COLS - 1 - c.col2) * SIZE.s;
+    } else if (axis == 'y') {
+        m->axis = (vec2s) {{ 0, 1 }};
+        room1   = c.row1 * SIZE.t;
+        room2   = (ROWS - 1 - c.row2) * SIZE.t;
+    } else {
+        main_term(EXIT_FAILURE, "Syntax error in level file.\n");
+    }
+    if (width < 1 || height < 1 || c.col1 < 0 || c.row1 < 0 || c.col2 >= COLS || c.row2 >= ROWS ||
+            period <= 0.0f || distance < 0.0f || distance > room1 || distance > room2) {
+        main_term(EXIT_FAILURE, "Moving block out of range in level file.\n");
+    }
+}
+
+void markMovers(Bricks* b)
+{
+    for (int m = 0; m < b->moverCount; m++) {
+        Cells c = b->movers[m].cells;
+        for (int row = c.row1; row <= c.row2; row++) {
+            for (int col = c.col1; col <= c.col2; col++) {
+                int i = row * COLS + col;
+                if (b->mover[i]) main_term(EXIT_FAILURE, "Moving blocks overlap in level file.\n");
+                b->mover[i] = m + 1;
+            }
+        }
+    }
+}
+
+// Redraw the moving bricks of the level being played
+void dirtyMovers(void)
+{
+    for (int m = 0; m < bricks.moverCount; m++) {
+        Cells c = bricks.movers[m].cells;
+        for (int row = c.row1; row <= c.row2; row++) {
+            for (int col = c.col1; col <= c.col2; col++) {
+                int i = row * COLS + col;
+                if (level_isBrick(i)) setBit(isDirty, i);
+            }
+        }
+    }
 }
 
 void readLevel(int level, const char *data)
 {
     int count = 0;
-    int col   = 0;
-    int row   = 0;
+
+    levels[level] = (Bricks) {};
 
     char c = '\0';
     while ((c = *data++) != '\0') {
@@ -79,25 +266,27 @@ void readLevel(int level, const char *data)
             while ((c = *data++) != '\n') {
                 // Comment
             }
+        } else if (c == '@') {
+            readMover(&levels[level], data);
+            while (*data != '\0' && *data++ != '\n') {
+                // Rest of the moving block
+            }
         } else if (c == 'x') {
             // No brick
-            levels[level][count++].isActive = false;
-            col++;
+            count++;
         } else if (isdigit(c) || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F')) {
-            levels[level][count++] = createBrick(c, col, row);
-            col++;
-        } else if (c == '\n') {
-            // Ignore blank line
-            if (col > 0) row++;
-            col = 0;
-        } else if (c != ' ' && c != '\t') {
+            if (count < CELLS) addBrick(&levels[level], c, count);
+            count++;
+        } else if (c != ' ' && c != '\t' && c != '\n') {
             main_term(EXIT_FAILURE, "Syntax error in level file.\n");
         }
     }
 
-    if (count != COLS * ROWS) {
+    if (count != CELLS) {
         main_term(EXIT_FAILURE, "Incorrect number of bricks in level file.\n");
     }
+
+    markMovers(&levels[level]);
 }
 
 void level_load(void)
@@ -116,40 +305,63 @@ void level_load(void)
 	util_unload(data);
     }
 
-    level = 0;
+    for (int i = 0; i < TYPES; i++) {
+        normalRects[i] = atlas_get(NORMAL_SPRITES[i]);
+        solidRects[i]  = atlas_get(SOLID_SPRITES[i]);
+    }
+    slots = rend_createSlots(CELLS);
+    level_reset();
 }
 
-void level_rend(Rend* r)
+void level_unload(void)
 {
-    for (int i = 0; i < COLS * ROWS; i++) {
-        Brick b = levels[level][i];
-        if (b.isActive && !b.isDestroyed) {
-            rend_sprite(r, b.sprite);
+    rend_unloadSlots(slots);
+}
+
+/* The bricks stay on the GPU, only the slots of bricks destroyed or moved
+ * since the last frame are updated, then they are all drawn in one call.
+ * Moving bricks are drawn between their last two steps by alpha, like the
+ * balls, so they move with every new alpha even without a step. */
+void level_rend(Rend* r, float alpha)
+{
+    if (alpha != rendAlpha) {
+        dirtyMovers();
+        rendAlpha = alpha;
+    }
+
+    // Visit the set bits of each word of dirty slots
+    for (int w = 0; w < WORDS; w++) {
+        uint64_t dirty = isDirty[w];
+        isDirty[w] = 0;
+        while (dirty) {
+            int i = w * BITS + __builtin_ctzll(dirty);
+            dirty &= dirty - 1;
+
+            if (level_isBrick(i)) {
+                const AtlasRect* rect = getBit(bricks.isSolid, i) ? &solidRects[bricks.type[i]]
+                    : &normalRects[bricks.type[i]];
+                vec3s col = getBit(bricks.isExplosive, i) ? BLAST : WHITE;
+                rend_setSlot(&slots, i, (Instance) { getRendPos(i, alpha), SIZE, rect->uv, rect->layer, col });
+            } else {
+                rend_clearSlot(&slots, i);
+            }
         }
     }
+
+    queue_slots(LayerBricks, r, &slots);
 }
 
 bool level_isClear(void)
 {
-    for (int i = 0; i < COLS * ROWS; i++) {
-        Brick b = levels[level][i];
-        if (b.isActive && !b.isSolid && !b.isDestroyed) return false;
-    }
-
-    return true;
+    return bricks.remaining == 0;
 }
 
 // Reset all levels
 void level_reset(void)
 {
-    for (int j = 0; j < COUNT; j++) {
-	for (int i = 0; i < COLS * ROWS; i++) {
-	    Brick* b = &levels[j][i];
-	    if (b->isActive && !b->isSolid && b->isDestroyed) b->isDestroyed = false;
-	}
-    }
-
     level = 0;
+    memcpy(&bricks, &levels[level], sizeof bricks);
+    startLevel();
 }
 
 // Returns false if game is won
@@ -157,6 +369,8 @@ bool level_next(void)
 {
     if (level < COUNT - 1) {
 	level++;
+	memcpy(&bricks, &levels[level], sizeof bricks);
+	startLevel();
 	return true;
     } else {
 	return false;
@@ -173,34 +387,283 @@ int level_getCount(void)
     return COUNT;
 }
 
-int level_getBrickCount(void)
+int level_getCols(void)
 {
-    return COLS * ROWS;
+    return COLS;
 }
 
-// Return a pointer to a sprite, nullptr means no brick
-Sprite* level_getBrickSprite(int brick)
+int level_getRows(void)
 {
-    Brick* b = &levels[level][brick];
-    if (b->isActive && !b->isDestroyed) {
-	return &b->sprite;
-    } else {
-	return nullptr;
+    return ROWS;
+}
+
+// Find the grid cells covered by the box min to max, false if it misses the grid
+bool getCells(vec2s min, vec2s max, Cells* c)
+{
+    int col1 = (int) floorf((min.x - WALL_LEFT) / SIZE.s);
+    int row1 = (int) floorf((min.y - WALL_TOP)  / SIZE.t);
+    int col2 = (int) floorf((max.x - WALL_LEFT) / SIZE.s);
+    int row2 = (int) floorf((max.y - WALL_TOP)  / SIZE.t);
+
+    if (col2 < 0 || row2 < 0 || col1 >= COLS || row1 >= ROWS) return false;
+
+    c->col1 = MAX(col1, 0);
+    c->row1 = MAX(row1, 0);
+    c->col2 = MIN(col2, COLS - 1);
+    c->row2 = MIN(row2, ROWS - 1);
+
+    return true;
+}
+
+// Cells a moving brick overlaps, the far edges are exclusive
+void coverCells(int brick, Cells* c)
+{
+    vec2s pos = level_getBrickPos(brick);
+    c->col1 = (int) floorf((pos.x - WALL_LEFT) / SIZE.s);
+    c->row1 = (int) floorf((pos.y - WALL_TOP)  / SIZE.t);
+    c->col2 = (int) ceilf((pos.x + SIZE.s - WALL_LEFT) / SIZE.s) - 1;
+    c->row2 = (int) ceilf((pos.y + SIZE.t - WALL_TOP)  / SIZE.t) - 1;
+}
+
+// Add a moving brick to the cells it covers
+void linkBrick(int brick)
+{
+    Cells c = covers[brick];
+    for (int row = c.row1; row <= c.row2; row++) {
+        for (int col = c.col1; col <= c.col2; col++) {
+            CellMovers* cm = &cellMovers[row * COLS + col];
+            if (cm->count == CELL_MOVERS) main_term(EXIT_FAILURE, "Too many moving bricks overlap.\n");
+            cm->bricks[cm->count++] = brick;
+        }
+    }
+}
+
+void unlinkBrick(int brick)
+{
+    Cells c = covers[brick];
+    for (int row = c.row1; row <= c.row2; row++) {
+        for (int col = c.col1; col <= c.col2; col++) {
+            CellMovers* cm = &cellMovers[row * COLS + col];
+            for (int i = 0; i < cm->count; i++) {
+                if (cm->bricks[i] == brick) {
+                    cm->bricks[i] = cm->bricks[--cm->count];
+                    break;
+                }
+            }
+        }
+    }
+}
+
+// Put the moving blocks back at their start, clear any explosions and redraw
+// every brick
+void startLevel(void)
+{
+    stamp++;
+    blastHead    = blastTail = 0;
+    pendingScore = pendingCount = 0;
+    moveTime     = 0;
+    memset(offsets, 0, sizeof offsets);
+    memset(prevOffsets, 0, sizeof prevOffsets);
+    memset(cellMovers, 0, sizeof cellMovers);
+    for (int i = 0; i < CELLS; i++) setBit(isDirty, i);
+
+    for (int i = 0; i < CELLS; i++) {
+        if (bricks.mover[i] && level_isBrick(i)) {
+            coverCells(i, &covers[i]);
+            linkBrick(i);
+        }
+    }
+}
+
+/* Set off the queued explosions, breadth first through the grid. Each takes
+ * out its neighbours and any explosive ones join the queue, so a chain
+ * spreads at BLAST_BUDGET bricks a tick. */
+void explode(void)
+{
+    for (int n = 0; n < BLAST_BUDGET && blastHead < blastTail; n++) {
+        int brick = blasts[blastHead++];
+        int col   = brick % COLS;
+        int row   = brick / COLS;
+        for (int r = MAX(row - 1, 0); r <= MIN(row + 1, ROWS - 1); r++) {
+            for (int c = MAX(col - 1, 0); c <= MIN(col + 1, COLS - 1); c++) {
+                level_destroyBrick(r * COLS + c);
+            }
+        }
+    }
+}
+
+/* Move the blocks on by dt and carry on any chain of explosions. Static
+ * bricks are never touched, a moving brick is only relinked when the cells
+ * it covers change. The score and sound for the bricks destroyed this tick
+ * are given out once. */
+void level_update(double dt)
+{
+    explode();
+    if (pendingCount > 0) {
+        paddle_incScore(pendingScore);
+        audio_playSound(SoundBrick);
+        pendingScore = pendingCount = 0;
+    }
+
+#ifdef FIXED_PHYSICS
+    moveTime += fix_fromFloat((float) dt);
+#else
+    moveTime += dt;
+#endif
+    memcpy(prevOffsets, offsets, sizeof offsets);
+
+    for (int m = 0; m < bricks.moverCount; m++) {
+        const Mover* mv = &bricks.movers[m];
+        offsets[m] = glms_vec2_scale(mv->axis, getOffset(mv));
+
+        Cells c = mv->cells;
+        for (int row = c.row1; row <= c.row2; row++) {
+            for (int col = c.col1; col <= c.col2; col++) {
+                int i = row * COLS + col;
+                if (!level_isBrick(i)) continue;
+
+                setBit(isDirty, i);
+                Cells cover;
+                coverCells(i, &cover);
+                if (memcmp(&cover, &covers[i], sizeof cover) != 0) {
+                    unlinkBrick(i);
+                    covers[i] = cover;
+                    linkBrick(i);
+                }
+            }
+        }
+    }
+}
+
+#ifdef FIXED_PHYSICS
+/* Distance of a moving block from its start along its axis. The balls collide
+ * with the bricks in 16.16, so the phase and the wave are worked out in 16.16
+ * too and the bricks are in the same place on every machine. */
+float getOffset(const Mover* mv)
+{
+    fixed period = MAX(fix_fromFloat(mv->period), 1);
+    fixed phase  = (fixed) (moveTime % period * FIX_ONE / period);
+
+    // Triangle wave, out to +1, back through to -1 and home
+    fixed q = FIX_ONE / 4;
+    fixed d = phase < q ? 4 * phase : (phase < 3 * q ? 2 * FIX_ONE - 4 * phase : 4 * phase - 4 * FIX_ONE);
+    if (mv->motion == MotionSwing) {
+        // The triangle folds the phase onto the first quarter of the sine
+        fixed d2 = fix_mul(d, d);
+        d = fix_mul(d, SIN_1 + fix_mul(d2, SIN_3 + fix_mul(d2, SIN_5)));
+    }
+
+    return fix_toFloat(fix_mul(d, fix_fromFloat(mv->distance)) & OFFSET_MASK);
+}
+#else
+// Distance of a moving block from its start along its axis
+float getOffset(const Mover* mv)
+{
+    float phase = (float) fmod(moveTime / mv->period, 1.0);
+    if (mv->motion == MotionSwing) return sinf(TAU * phase) * mv->distance;
+
+    // Triangle wave, out to +1, back through to -1 and home
+    float d = phase < 0.25f ? 4.0f * phase : (phase < 0.75f ? 2.0f - 4.0f * phase : 4.0f * phase - 4.0f);
+    return d * mv->distance;
+}
+#endif
+
+bool level_hasMovers(void)
+{
+    return bricks.moverCount > 0;
+}
+
+// Bricks can only be destroyed during a level, so anything worked out from
+// the layout stays valid until this changes, unless there are moving blocks
+int level_getStamp(void)
+{
+    return stamp;
+}
+
+/* Broadphase: find the bricks that may overlap the box min to max, so only
+ * those need a swept test. Static bricks come from the grid bitsets and
+ * moving bricks from the cells they cover. Returns the number found, at most
+ * size. */
+int level_query(vec2s min, vec2s max, int* found, int size)
+{
+    Cells c;
+    if (!getCells(min, max, &c)) return 0;
+
+    int n = 0;
+    for (int row = c.row1; row <= c.row2; row++) {
+        for (int col = c.col1; col <= c.col2; col++) {
+            int i = row * COLS + col;
+            if (!bricks.mover[i] && level_isBrick(i) && n < size) found[n++] = i;
+
+            // A moving brick covering several cells is found from the first one
+            const CellMovers* cm = &cellMovers[i];
+            for (int k = 0; k < cm->count && n < size; k++) {
+                int brick = cm->bricks[k];
+                if (col == MAX(covers[brick].col1, c.col1) && row == MAX(covers[brick].row1, c.row1)) {
+                    found[n++] = brick;
+                }
+            }
+        }
     }
+
+    return n;
 }
 
-void updateScore(int i)
+bool level_isBrick(int brick)
+{
+    return getBit(bricks.isActive, brick) && !getBit(bricks.isDestroyed, brick);
+}
+
+bool level_isSolid(int brick)
+{
+    return getBit(bricks.isSolid, brick);
+}
+
+// Bricks are stored by cell, so the position comes from the grid
+vec2s level_getBrickPos(int brick)
+{
+    int col = brick % COLS;
+    int row = brick / COLS;
+    vec2s pos = {{ WALL_LEFT + col * SIZE.s, WALL_TOP + row * SIZE.t }};
+    if (bricks.mover[brick]) pos = glms_vec2_add(pos, offsets[bricks.mover[brick] - 1]);
+    return pos;
+}
+
+// Where to draw a brick, a moving one between its last two steps by alpha
+vec2s getRendPos(int brick, float alpha)
+{
+    vec2s pos = level_getBrickPos(brick);
+    int   m   = bricks.mover[brick] - 1;
+    if (m < 0) return pos;
+
+    vec2s step = glms_vec2_sub(offsets[m], prevOffsets[m]);
+    return glms_vec2_sub(pos, glms_vec2_scale(step, 1.0f - alpha));
+}
+
+vec2s level_getBrickSize(void)
+{
+    return SIZE;
+}
+
+int getScore(int i)
 {
     int row = i / COLS;
-    paddle_incScore((level + 1) * (ROWS - row));
+    return (level + 1) * (ROWS - row);
 }
 
+void destroyBrick(int brick)
+{
+    setBit(bricks.isDestroyed, brick);
+    setBit(isDirty, brick);
+    if (bricks.mover[brick]) unlinkBrick(brick);
+    if (getBit(bricks.isExplosive, brick)) blasts[blastTail++] = brick;
+    bricks.remaining--;
+    pendingScore += getScore(brick);
+    pendingCount++;
+}
+
+// Scored at the end of the tick, explosive bricks go off over the next ticks
 void level_destroyBrick(int brick)
 {
-    Brick* b = &levels[level][brick];
-    if (!b->isSolid) {
-	b->isDestroyed = true;
-	updateScore(brick);
-	audio_playSound(SoundBrick);
-    }
+    if (level_isBrick(brick) && !getBit(bricks.isSolid, brick)) destroyBrick(brick);
 }
@@ -6,16 +6,26 @@
 #include "../gfx/sprite.h"
 
 // Constants
-constexpr int COUNT = 7;
+constexpr int COUNT     = 7;
+constexpr int QUERY_MAX = 256; // Enough bricks for any query the ball makes
 
 // Function prototypes
 void    level_load(void);
-void    level_rend(Rend* r);
+void    level_unload(void);
+void    level_rend(Rend* r, float alpha);
 bool    level_isClear(void);
 void    level_reset(void);
 bool    level_next(void);
 int     level_getCurrent(void);
 int     level_getCount(void);
-int     level_getBrickCount(void);
-Sprite* level_getBrickSprite(int brick);
+int     level_getCols(void);
+int     level_getRows(void);
+void    level_update(double dt);
+bool    level_hasMovers(void);
+int     level_getStamp(void);
+int     level_query(vec2s min, vec2s max, int* found, int size);
+bool    level_isBrick(int brick);
+bool    level_isSolid(int brick);
+vec2s   level_getBrickPos(int brick);
+vec2s   level_getBrickSize(void);
 void    level_destroyBrick(int brick);
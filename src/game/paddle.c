@@ -1,18 +1,22 @@
 #include <cglm/struct.h> // vec2s
 
+#include "../collider.h"
 #include "../main.h"
+#include "../gfx/atlas.h"
+#include "../gfx/queue.h"
 #include "../gfx/rend.h"
 #include "../gfx/sprite.h"
+#include "draw.h"
 #include "paddle.h"
 
 // Constants
 static const vec2s SIZE        = {{ 144, 24 }};
-static const vec2s TEX_OFFSET  = {{ 384, 0 }};
 static const vec2s LIVES_POS[] = { {{ 18, 1053 }}, {{ 18, 1027 }} };
 static const int   LIVES       = 3;
 
 // Variables
 static Sprite  paddle;
+static Box     box; // Collider, kept in step with the sprite
 static int     score;
 static int     lives;
 static Sprite* livesSprites;
@@ -29,13 +33,14 @@ void paddle_init(void)
 {
     paddle_resetStats();
 
-    vec2s pos     = {{ main_getMousePos().x, SCR_HEIGHT - SIZE.t }};
-    vec2s texSize = (vec2s) {{ SCR_WIDTH, SCR_HEIGHT }};
-    paddle        = sprite_create(pos, SIZE, TEX_OFFSET, texSize);
+    vec2s     pos  = {{ main_getMousePos().x, SCR_HEIGHT - SIZE.t }};
+    AtlasRect rect = atlas_get("paddle");
+    paddle         = sprite_create(pos, SIZE, rect.uv, rect.layer);
+    box            = (Box) { pos, glms_vec2_add(pos, SIZE) };
 
     livesSprites = (Sprite *) malloc((LIVES - 1) * sizeof(Sprite));
     for (int i = 0; i < LIVES - 1; i++) {
-        livesSprites[i] = sprite_create(LIVES_POS[i], SIZE, TEX_OFFSET, texSize);
+        livesSprites[i] = sprite_create(LIVES_POS[i], SIZE, rect.uv, rect.layer);
     }
 }
 
@@ -43,6 +48,7 @@ void paddle_setX(float x)
 {
     vec2s newPos = {{ x, paddle.pos.y }};
     sprite_setPos(&paddle, newPos);
+    box = (Box) { newPos, glms_vec2_add(newPos, SIZE) };
 }
 
 Sprite paddle_getSprite(void)
@@ -50,11 +56,16 @@ Sprite paddle_getSprite(void)
     return paddle;
 }
 
+const Box* paddle_getBox(void)
+{
+    return &box;
+}
+
 void paddle_rend(Rend* r)
 {
-    rend_sprite(r, paddle);
+    queue_sprite(LayerSprites, r, &paddle);
     for (int i = 0; i < lives - 1; i++) {
-	rend_sprite(r, livesSprites[i]);
+	queue_sprite(LayerSprites, r, &livesSprites[i]);
     }
 }
 
@@ -1,13 +1,17 @@
 #include "../main.h"
 #include "../util.h"
+#include "../gfx/queue.h"
 #include "../gfx/rend.h"
 #include "../gfx/sprite.h"
+#include "draw.h"
 #include "paddle.h"
 #include "parallax.h"
 #include "wall.h"
 
 // Constants
-static const char* FILES[]  = { "gfx/stars1.png", "gfx/stars2.png" };
+// Own textures rather than atlas layers, the images are far larger than the
+// sprite sheet and would size every layer
+static const char* FILES[]  = { "gfx/stars1.png", "gfx/stars2.png" }; // Furthest first
 static const float RATIOS[] = { 0.000015f, 0.00002f };
 static const vec2s TEX_OFF  = {{ 500, 500 }}; // Initial offset into texture
 constexpr size_t COUNT = COUNT(FILES);
@@ -24,7 +28,7 @@ void parallax_load(void)
 
 	vec2s pos  = {{ WALL_LEFT, WALL_TOP }};
 	vec2s size = {{ SCR_WIDTH - WALL_LEFT - WALL_RIGHT, SCR_HEIGHT - WALL_TOP }};
-	sprites[i] = sprite_create(pos, size, TEX_OFF, rends[i].tex.size);
+	sprites[i] = sprite_create(pos, size, sprite_uv(size, TEX_OFF, rends[i].tex.size), 0.0f);
     }
 
     paddlePrevX = paddle_getSprite().pos.x;
@@ -49,8 +53,6 @@ void parallax_onPaddleMove(void)
 void parallax_rend(void)
 {
     for (size_t i = 0; i < COUNT; i++) {
-	rend_begin(rends[i]);
-	rend_sprite(&rends[i], sprites[i]);
-	rend_end(&rends[i]);
+	queue_sprite(LayerStars, &rends[i], &sprites[i]);
     }
 }
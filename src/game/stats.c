@@ -0,0 +1,71 @@
+/*
+ * Physics counters. The balls are stepped on several threads, so each slice
+ * adds up its own counts and hands them over once with stats_add(). Frames
+ * are closed with stats_endFrame(), which keeps the session totals and the
+ * worst frame for each counter.
+ */
+
+#include <stdatomic.h> // atomic_*
+#include <stdio.h>     // printf
+
+#include "stats.h"
+
+// Constants
+static const char* NAMES[] = {
+    "Ball steps",
+    "Swept tests",
+    "Iterations",
+    "Out of budget",
+    "Dropped time",
+    "Tunnelled",
+    "Predictions",
+};
+
+// Variables
+static _Atomic long current[StatCount]; // Frame in progress
+static Stats        frame;              // Last complete frame
+static Stats        session;
+static Stats        peaks;              // Worst frame for each counter
+static long         peakFrames[StatCount];
+static long         frameCount;         // Frames with any physics
+static long         frameNumber;        // Every frame, to find the peaks
+
+// Function definitions
+
+void stats_add(const Stats* s)
+{
+    for (int i = 0; i < StatCount; i++) {
+	if (s->counts[i]) atomic_fetch_add_explicit(&current[i], s->counts[i], memory_order_relaxed);
+    }
+}
+
+void stats_endFrame(void)
+{
+    frameNumber++;
+
+    bool isEmpty = true;
+    for (int i = 0; i < StatCount; i++) {
+	frame.counts[i] = atomic_exchange_explicit(&current[i], 0, memory_order_relaxed);
+	if (frame.counts[i]) isEmpty = false;
+    }
+    if (isEmpty) return;
+
+    frameCount++;
+    for (int i = 0; i < StatCount; i++) {
+	session.counts[i] += frame.counts[i];
+	if (frame.counts[i] > peaks.counts[i]) {
+	    peaks.counts[i] = frame.counts[i];
+	    peakFrames[i]   = frameNumber;
+	}
+    }
+}
+
+void stats_print(void)
+{
+    printf("Physics over %li frames\n", frameCount);
+    printf("%-18s %12s %12s %12s %8s\n", "", "Total", "Per frame", "Peak", "Frame");
+    for (int i = 0; i < StatCount; i++) {
+	double mean = frameCount ? (double) session.counts[i] / frameCount : 0.0;
+	printf("%-18s %12li %12.1f %12li %8li\n", NAMES[i], session.counts[i], mean, peaks.counts[i], peakFrames[i]);
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+// Types
+typedef enum {
+    StatSteps,      // Balls stepped
+    StatSweeps,     // Swept tests against colliders
+    StatIterations, // Collision loop iterations
+    StatBudgets,    // Steps that ran out of contacts with time left
+    StatDrops,      // Steps that dropped time past the carry limit
+    StatTunnels,    // Steps that ended with the ball overlapping a collider
+    StatPredicts,   // Next impacts worked out for event driven stepping
+    StatCount
+} Stat;
+
+typedef struct {
+    long counts[StatCount];
+} Stats;
+
+// Function prototypes
+void  stats_add(const Stats* s);
+void  stats_endFrame(void);
+void  stats_print(void);
@@ -2,34 +2,18 @@
 
 #include "../gfx/font.h"
 #include "asset.h"
+#include "draw.h"
 #include "text.h"
 
 // Function definitions
 
-static Font* currentFont = NULL;
-
+// Text goes on top of everything, from the atlas with its colour in each glyph
 void text_rend(Text t, ...)
 {
-    Font* f = asset_getFont(t.size);
-
-    if (currentFont != f) {
-        if (currentFont) font_end(currentFont);
-        font_begin(*f, t.col);
-        currentFont = f;
-    }
-
     va_list args;
     va_start(args, t);
 
-    font_vprintf(f, t.pos, t.fmt, args);
+    font_vprintf(asset_getFont(t.size), asset_getSpriteRend(), LayerText, t.pos, t.col, t.fmt, args);
 
     va_end(args);
 }
-
-void text_flush()
-{
-    if (currentFont) {
-        font_end(currentFont);
-        currentFont = NULL;
-    }
-}
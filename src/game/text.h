@@ -21,4 +21,3 @@ typedef struct
 
 // Function prototypes
 void text_rend(Text t, ...);
-void text_flush();
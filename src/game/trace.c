@@ -0,0 +1,255 @@
+/*
+ * Predict the path of a ball, for an aim guide or automated play.
+ *
+ * The ball is traced as a ray from its centre, with the walls moved in and
+ * the bricks grown by half the ball size so the result matches the swept
+ * box the game uses. The brick grid is walked cell by cell with a DDA
+ * (Amanatides & Woo), testing only the bricks that can reach each cell, so a
+ * trace costs O(cells crossed) and nothing is allocated. Moving bricks are
+ * taken where they are now.
+ */
+
+#include <cglm/struct.h> // vec2s
+#include <math.h>        // floorf, fminf, fmaxf, fabsf, INFINITY
+
+#include "../collider.h"
+#include "../main.h"
+#include "../util.h"
+#include "level.h"
+#include "paddle.h"
+#include "trace.h"
+#include "wall.h"
+
+// Function prototypes
+static bool isPassed(const Trace* t, int brick);
+static bool castBox(vec2s o, vec2s dir, vec2s min, vec2s max, float* time, vec2s* normal);
+static bool castBricks(vec2s o, vec2s dir, float end, vec2s half, const Trace* t, Impact* hit, float* time);
+
+// Function definitions
+
+// Bricks already hit by this trace will have been destroyed
+bool isPassed(const Trace* t, int brick)
+{
+    if (level_isSolid(brick)) return false;
+
+    for (int i = 0; i < t->count; i++) {
+	if (t->impacts[i].brick == brick) return true;
+    }
+    return false;
+}
+
+/* Ray against box, slab test. Only counts boxes the ray enters from outside,
+ * so a ray leaving the box it just bounced off isn't a hit. Grazing a corner,
+ * entry equal to exit, is a hit as it is for collider_sweepBox(). */
+bool castBox(vec2s o, vec2s dir, vec2s min, vec2s max, float* time, vec2s* normal)
+{
+    float xNear = -INFINITY, xFar = INFINITY;
+    float yNear = -INFINITY, yFar = INFINITY;
+
+    if (dir.x != 0.0f) {
+	float t1 = (min.x - o.x) / dir.x;
+	float t2 = (max.x - o.x) / dir.x;
+	xNear = fminf(t1, t2);
+	xFar  = fmaxf(t1, t2);
+    } else if (o.x <= min.x || o.x >= max.x) {
+	return false;
+    }
+
+    if (dir.y != 0.0f) {
+	float t1 = (min.y - o.y) / dir.y;
+	float t2 = (max.y - o.y) / dir.y;
+	yNear = fminf(t1, t2);
+	yFar  = fmaxf(t1, t2);
+    } else if (o.y <= min.y || o.y >= max.y) {
+	return false;
+    }
+
+    float entryTime = fmaxf(xNear, yNear);
+    float exitTime  = fminf(xFar, yFar);
+    if (entryTime < 0.0f || entryTime > exitTime) return false;
+
+    *time = entryTime;
+    if (xNear > yNear) {
+	*normal = (vec2s) {{ dir.x > 0.0f ? -1.0f : 1.0f, 0.0f }};
+    } else {
+	*normal = (vec2s) {{ 0.0f, dir.y > 0.0f ? -1.0f : 1.0f }};
+    }
+    return true;
+}
+
+/* Walk the grid cells along the ray up to end. A grown brick reaches into
+ * the neighbouring cells, so the broadphase is asked for the cell grown by
+ * the ball. A hit is only taken once the walk has passed it, so the first
+ * hit found is the earliest. */
+bool castBricks(vec2s o, vec2s dir, float end, vec2s half, const Trace* t, Impact* hit, float* time)
+{
+    int   cols = level_getCols();
+    int   rows = level_getRows();
+    vec2s size = level_getBrickSize();
+
+    // Clip to the grid, grown by the ball
+    vec2s gridMin = {{ WALL_LEFT - half.x, WALL_TOP - half.y }};
+    vec2s gridMax = {{ WALL_LEFT + cols * size.s + half.x, WALL_TOP + rows * size.t + half.y }};
+    float start = 0.0f;
+    for (int axis = 0; axis < 2; axis++) {
+	if (dir.raw[axis] != 0.0f) {
+	    float t1 = (gridMin.raw[axis] - o.raw[axis]) / dir.raw[axis];
+	    float t2 = (gridMax.raw[axis] - o.raw[axis]) / dir.raw[axis];
+	    start = fmaxf(start, fminf(t1, t2));
+	    end   = fminf(end, fmaxf(t1, t2));
+	} else if (o.raw[axis] < gridMin.raw[axis] || o.raw[axis] > gridMax.raw[axis]) {
+	    return false;
+	}
+    }
+    if (start > end) return false;
+
+    vec2s p    = glms_vec2_add(o, glms_vec2_scale(dir, start));
+    int   col  = (int) floorf((p.x - WALL_LEFT) / size.s);
+    int   row  = (int) floorf((p.y - WALL_TOP)  / size.t);
+    int   colStep = dir.x > 0.0f ? 1 : -1;
+    int   rowStep = dir.y > 0.0f ? 1 : -1;
+
+    // Ray distance to the next column and row boundary, and between them
+    float colNext  = INFINITY, rowNext  = INFINITY;
+    float colDelta = INFINITY, rowDelta = INFINITY;
+    if (dir.x != 0.0f) {
+	colNext  = (WALL_LEFT + (col + (colStep > 0)) * size.s - o.x) / dir.x;
+	colDelta = size.s / fabsf(dir.x);
+    }
+    if (dir.y != 0.0f) {
+	rowNext  = (WALL_TOP + (row + (rowStep > 0)) * size.t - o.y) / dir.y;
+	rowDelta = size.t / fabsf(dir.y);
+    }
+
+    for (;;) {
+	float cellEnd = fminf(fminf(colNext, rowNext), end);
+
+	// Bricks that can reach the cell, grown by the ball
+	vec2s cellMin = {{ WALL_LEFT + col * size.s, WALL_TOP + row * size.t }};
+	vec2s cellMax = glms_vec2_add(glms_vec2_add(cellMin, size), half);
+	int   found[QUERY_MAX];
+	int   count = level_query(glms_vec2_sub(cellMin, half), cellMax, found, QUERY_MAX);
+
+	float best = INFINITY;
+	for (int k = 0; k < count; k++) {
+	    int i = found[k];
+	    if (isPassed(t, i)) continue;
+
+	    vec2s pos = level_getBrickPos(i);
+	    vec2s min = glms_vec2_sub(pos, half);
+	    vec2s max = glms_vec2_add(glms_vec2_add(pos, size), half);
+	    float boxTime;
+	    vec2s normal;
+	    if (castBox(o, dir, min, max, &boxTime, &normal) && boxTime < best) {
+		best        = boxTime;
+		hit->normal = normal;
+		hit->brick  = i;
+	    }
+	}
+	if (best <= cellEnd) {
+	    hit->type = ImpactBrick;
+	    *time     = best;
+	    return true;
+	}
+
+	if (cellEnd >= end) return false;
+	if (colNext < rowNext) {
+	    col     += colStep;
+	    colNext += colDelta;
+	} else {
+	    row     += rowStep;
+	    rowNext += rowDelta;
+	}
+    }
+}
+
+/* Trace a ball moving in direction dir for up to bounces impacts. Hit bricks
+ * are taken as destroyed for the rest of the trace and the paddle deflects
+ * the ball the same way as in play. The trace stops early if the ball gets
+ * past the paddle. */
+void trace_predict(const Box* ball, vec2s dir, int bounces, Trace* t)
+{
+    t->count    = 0;
+    t->isLanded = false;
+
+    dir = glms_vec2_normalize(dir);
+    if (dir.x == 0.0f && dir.y == 0.0f) return;
+    bounces = MIN(bounces, TRACE_MAX);
+
+    const Box* paddle = paddle_getBox();
+    vec2s      half   = glms_vec2_scale(glms_vec2_sub(ball->max, ball->min), 0.5f);
+    vec2s      o      = glms_vec2_add(ball->min, half);
+
+    // Limits for the centre of the ball
+    float left   = WALL_LEFT + half.x;
+    float right  = SCR_WIDTH - WALL_RIGHT - half.x;
+    float top    = WALL_TOP + half.y;
+    float bottom = paddle->min.y - half.y;
+
+    while (t->count < bounces) {
+	// The ray always ends at a wall or the paddle's y
+	Impact hit  = { .type = ImpactWall, .brick = -1 };
+	float  time = INFINITY;
+	if (dir.x < 0.0f) {
+	    time       = (left - o.x) / dir.x;
+	    hit.normal = (vec2s) {{ 1.0f, 0.0f }};
+	} else if (dir.x > 0.0f) {
+	    time       = (right - o.x) / dir.x;
+	    hit.normal = (vec2s) {{ -1.0f, 0.0f }};
+	}
+	float y = dir.y < 0.0f ? top : bottom;
+	if (dir.y != 0.0f && (y - o.y) / dir.y < time) {
+	    time       = (y - o.y) / dir.y;
+	    hit.type   = dir.y < 0.0f ? ImpactWall : ImpactPaddle;
+	    hit.normal = (vec2s) {{ 0.0f, dir.y < 0.0f ? 1.0f : -1.0f }};
+	}
+	time = fmaxf(time, 0.0f);
+
+	Impact brick;
+	float  brickTime;
+	if (castBricks(o, dir, time, half, t, &brick, &brickTime)) {
+	    hit  = brick;
+	    time = brickTime;
+	}
+
+	o = glms_vec2_add(o, glms_vec2_scale(dir, time));
+	hit.pos = glms_vec2_sub(o, half);
+
+	if (hit.type == ImpactPaddle) {
+	    if (!t->isLanded) {
+		t->isLanded = true;
+		t->land     = hit.pos;
+	    }
+
+	    // Missed the paddle
+	    if (o.x < paddle->min.x - half.x || o.x > paddle->max.x + half.x) break;
+
+	    // Same deflection as the ball gets off the top of the paddle
+	    float paddleHalf   = (paddle->max.x - paddle->min.x) / 2.0f;
+	    float paddleCenter = paddle->min.x + paddleHalf;
+	    dir = glms_vec2_normalize((vec2s) {{ (o.x - paddleCenter) / paddleHalf, -dir.y }});
+	} else {
+	    dir = glms_vec2_reflect(dir, hit.normal);
+	}
+
+	t->impacts[t->count++] = hit;
+    }
+}
+
+/* Distance the ball can move along dir before it hits a wall or brick or
+ * reaches the paddle's y, for stepping without collision tests until then. */
+float trace_getClearance(const Box* ball, vec2s dir)
+{
+    Trace t;
+    trace_predict(ball, dir, 1, &t);
+
+    vec2s end;
+    if (t.count > 0) {
+	end = t.impacts[0].pos;
+    } else if (t.isLanded) {
+	end = t.land;
+    } else {
+	return 0.0f;
+    }
+    return glms_vec2_norm(glms_vec2_sub(end, ball->min));
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cglm/struct.h> // vec2s
+
+#include "../collider.h"
+
+// Constants
+constexpr int TRACE_MAX = 32; // Most impacts a trace can return
+
+// Types
+typedef enum
+{
+    ImpactWall,
+    ImpactBrick,
+    ImpactPaddle
+} ImpactType;
+
+typedef struct {
+    ImpactType type;
+    vec2s      pos;    // Ball position at the impact
+    vec2s      normal;
+    int        brick;  // Brick hit, -1 if not a brick
+} Impact;
+
+typedef struct {
+    Impact impacts[TRACE_MAX];
+    int    count;
+    bool   isLanded; // Reached the paddle's y
+    vec2s  land;     // Ball position where it reached the paddle's y
+} Trace;
+
+// Function prototypes
+void  trace_predict(const Box* ball, vec2s dir, int bounces, Trace* t);
+float trace_getClearance(const Box* ball, vec2s dir);
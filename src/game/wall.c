@@ -1,7 +1,7 @@
 #include <cglm/struct.h> // vec2s
 
+#include "../collider.h"
 #include "../main.h"
-#include "../gfx/sprite.h"
 #include "wall.h"
 
 // Constants
@@ -9,26 +9,17 @@ const float WALL_TOP   = 72.0f;
 const float WALL_LEFT  = 192.0f;
 const float WALL_RIGHT = 192.0f;
 
-Sprite walls[WallCount];
+Plane walls[WallCount];
 
-// Create dummy sprites for collisions
+// The walls only collide, so are half-planes facing into the play area
 void wall_init(void)
 {
-    vec2s unused = {{ 0, 0 }}; // texOffset and texSize are unused
-
-    vec2s pos  = {{ 0, 0 }};
-    vec2s size = {{ SCR_WIDTH, WALL_TOP }};
-    walls[WallTop] = sprite_create(pos, size, unused, unused);
-
-    size = (vec2s) {{ WALL_LEFT, SCR_HEIGHT }};
-    walls[WallLeft] = sprite_create(pos, size, unused, unused);
-
-    pos  = (vec2s) {{ SCR_WIDTH - WALL_RIGHT, 0 }};
-    size = (vec2s) {{ WALL_RIGHT, SCR_HEIGHT }};
-    walls[WallRight] = sprite_create(pos, size, unused, unused);
+    walls[WallTop]   = (Plane) { {{ 0.0f, 1.0f }},  WALL_TOP };
+    walls[WallLeft]  = (Plane) { {{ 1.0f, 0.0f }},  WALL_LEFT };
+    walls[WallRight] = (Plane) { {{ -1.0f, 0.0f }}, -(SCR_WIDTH - WALL_RIGHT) };
 }
 
-Sprite wall_getSprite(Wall w)
+const Plane* wall_getPlane(Wall w)
 {
-    return walls[w];
+    return &walls[w];
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../collider.h"
+
 // Types
 typedef enum
 {
@@ -15,5 +17,5 @@ extern const float WALL_LEFT;
 extern const float WALL_RIGHT;
 
 // Function prototypes
-void   wall_init(void);
-Sprite wall_getSprite(Wall w);
+void         wall_init(void);
+const Plane* wall_getPlane(Wall w);
@@ -0,0 +1,215 @@
+/*
+ * One texture array holding the sprite sheet and the fonts, so the sprites
+ * and text can be drawn in one batch. What goes in it is described by an
+ * atlas file kept with the art, see gfx/atlas.txt: each image is a layer,
+ * the fonts are packed together into one more and sprites are named
+ * rectangles of an image. The layers are as wide as the widest image and as
+ * high as the highest, smaller images sit in the top left corner. The array
+ * takes the format tex_load() would pick for its images, RGBA as the fonts
+ * need alpha.
+ */
+
+#undef  GLAD_GL_IMPLEMENTATION
+
+#include <cglm/struct.h>   // vec2s, vec4s
+#include <glad.h>          // GL*
+#include <stb/stb_image.h> // stbi_load, stbi_image_free
+#include <stdio.h>         // sscanf
+#include <stdlib.h>        // malloc, free
+#include <string.h>        // strcmp
+
+#include "../main.h"
+#include "../util.h"
+#include "atlas.h"
+#include "font.h"
+#include "sprite.h"
+#include "tex.h"
+
+// Constants
+constexpr int LAYER_MAX  = 8;
+constexpr int SPRITE_MAX = 32;
+constexpr int NAME_MAX   = 16;
+constexpr int FILE_MAX   = 64;
+constexpr int FONT_SIZE  = 1024; // Side of the room for every font, in the top left of their layer
+
+// Types
+
+typedef struct {
+    char           name[NAME_MAX];
+    char           file[FILE_MAX];
+    bool           isFont;
+    float          height; // Pixel height of a font
+    Font           font;
+    int            index;  // Of the texture array, the fonts share one
+    int            imageWidth;
+    int            imageHeight;
+    unsigned char* image;  // RGBA, while loading
+} Layer;
+
+typedef struct {
+    char      name[NAME_MAX];
+    vec2s     offset; // Pixels into the layer
+    int       layer;  // In the atlas file
+    AtlasRect rect;
+} Entry;
+
+// Function prototypes
+static int  findLayer(const char* name);
+static void readLine(const char* line);
+static void readAtlas(const char* data);
+static void loadImages(int* width, int* height, int* count, bool* isOpaque);
+static void loadFonts(Tex tex, int index);
+
+// Variables
+static Layer layers[LAYER_MAX];
+static int   layerCount;
+static Entry entries[SPRITE_MAX];
+static int   entryCount;
+
+// Function definitions
+
+int findLayer(const char* name)
+{
+    for (int i = 0; i < layerCount; i++) {
+        if (strcmp(layers[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/* One of:
+ * layer name file
+ * font name file height
+ * sprite name layer x y width height */
+void readLine(const char* line)
+{
+    char kind[8];
+    if (sscanf(line, "%7s", kind) != 1) return;
+
+    if (strcmp(kind, "layer") == 0 || strcmp(kind, "font") == 0) {
+        if (layerCount == LAYER_MAX) main_term(EXIT_FAILURE, "Too many layers in atlas file.\n");
+        Layer* l = &layers[layerCount++];
+        *l = (Layer) { .isFont = strcmp(kind, "font") == 0 };
+        int count = sscanf(line, "%*s %15s %63s %f", l->name, l->file, &l->height);
+        if (count != (l->isFont ? 3 : 2)) main_term(EXIT_FAILURE, "Syntax error in atlas file.\n");
+    } else if (strcmp(kind, "sprite") == 0) {
+        if (entryCount == SPRITE_MAX) main_term(EXIT_FAILURE, "Too many sprites in atlas file.\n");
+        Entry* e = &entries[entryCount++];
+        char layer[NAME_MAX];
+        if (sscanf(line, "%*s %15s %15s %f %f %f %f", e->name, layer, &e->offset.x, &e->offset.y,
+                    &e->rect.size.s, &e->rect.size.t) != 6) {
+            main_term(EXIT_FAILURE, "Syntax error in atlas file.\n");
+        }
+        int i = findLayer(layer);
+        if (i < 0 || layers[i].isFont) main_term(EXIT_FAILURE, "Unknown layer in atlas file: %s\n", layer);
+        e->layer = i;
+    } else {
+        main_term(EXIT_FAILURE, "Syntax error in atlas file.\n");
+    }
+}
+
+void readAtlas(const char* data)
+{
+    layerCount = entryCount = 0;
+
+    while (*data != '\0') {
+        if (*data != '#') readLine(data);
+        while (*data != '\0' && *data++ != '\n') {
+            // Rest of the line
+        }
+    }
+}
+
+/* Load the images of the atlas, giving each a layer. The size of the layers
+ * is the largest image, count is the layers taken. */
+void loadImages(int* width, int* height, int* count, bool* isOpaque)
+{
+    *width = *height = *count = 0;
+    *isOpaque = true;
+    for (int i = 0; i < layerCount; i++) {
+        Layer* l = &layers[i];
+        if (l->isFont) continue;
+
+        int chan;
+        l->image = stbi_load(l->file, &l->imageWidth, &l->imageHeight, &chan, 4);
+        if (!l->image) main_term(EXIT_FAILURE, "Could not load image: %s\n", l->file);
+        l->index  = (*count)++;
+        *width    = MAX(*width, l->imageWidth);
+        *height   = MAX(*height, l->imageHeight);
+        *isOpaque = *isOpaque && tex_isOpaque(l->image, (size_t) l->imageWidth * l->imageHeight);
+    }
+}
+
+// Pack every font into the top left of layer index
+void loadFonts(Tex tex, int index)
+{
+    FontPack pack;
+    font_beginPack(&pack, FONT_SIZE, FONT_SIZE);
+    for (int i = 0; i < layerCount; i++) {
+        Layer* l = &layers[i];
+        if (!l->isFont) continue;
+        l->font  = font_load(&pack, l->height, l->file, index, (int) tex.size.x, (int) tex.size.y);
+        l->index = index;
+    }
+
+    unsigned char* pixels = (unsigned char*) malloc((size_t) FONT_SIZE * FONT_SIZE * 4);
+    if (!pixels) main_term(EXIT_FAILURE, "Could not allocate the font layer.\n");
+    font_endPack(&pack, pixels);
+    tex_setLayer(tex, index, FONT_SIZE, FONT_SIZE, GL_RGBA, pixels);
+    free(pixels);
+}
+
+// Build the texture array, the caller owns it
+Tex atlas_load(const char* file)
+{
+    char* data = util_load(file, READ_ONLY_TEXT);
+    if (!data) main_term(EXIT_FAILURE, "Unable to load atlas: %s\n", file);
+    readAtlas(data);
+    util_unload(data);
+
+    int  width, height, count;
+    bool isOpaque;
+    loadImages(&width, &height, &count, &isOpaque);
+
+    bool hasFonts = false;
+    for (int i = 0; i < layerCount; i++) hasFonts = hasFonts || layers[i].isFont;
+    if (hasFonts) {
+        width    = MAX(width, FONT_SIZE);
+        height   = MAX(height, FONT_SIZE);
+        isOpaque = false;
+        count++;
+    }
+
+    Tex tex = tex_create(tex_getFormat(4, isOpaque), width, height, count, GL_RGBA, nullptr);
+    for (int i = 0; i < layerCount; i++) {
+        Layer* l = &layers[i];
+        if (l->isFont) continue;
+        tex_setLayer(tex, l->index, l->imageWidth, l->imageHeight, GL_RGBA, l->image);
+        stbi_image_free(l->image);
+        l->image = nullptr;
+    }
+    if (hasFonts) loadFonts(tex, count - 1);
+
+    vec2s texSize = {{ width, height }};
+    for (int i = 0; i < entryCount; i++) {
+        entries[i].rect.uv    = sprite_uv(entries[i].rect.size, entries[i].offset, texSize);
+        entries[i].rect.layer = layers[entries[i].layer].index;
+    }
+
+    return tex;
+}
+
+AtlasRect atlas_get(const char* name)
+{
+    for (int i = 0; i < entryCount; i++) {
+        if (strcmp(entries[i].name, name) == 0) return entries[i].rect;
+    }
+    main_term(EXIT_FAILURE, "No sprite %s in atlas.\n", name);
+    return (AtlasRect) {};
+}
+
+Font* atlas_getFont(const char* name)
+{
+    int i = findLayer(name);
+    if (i < 0 || !layers[i].isFont) main_term(EXIT_FAILURE, "No font %s in atlas.\n", name);
+    return &layers[i].font;
+}
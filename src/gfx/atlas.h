@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cglm/struct.h> // vec2s, vec4s
+
+#include "font.h"
+#include "tex.h"
+
+// Types
+
+// Where a sprite is in the atlas
+typedef struct {
+    vec2s size;  // Pixels
+    vec4s uv;    // Top left and bottom right texture coordinates
+    float layer;
+} AtlasRect;
+
+// Function prototypes
+Tex       atlas_load(const char* file);
+AtlasRect atlas_get(const char* name);
+Font*     atlas_getFont(const char* name);
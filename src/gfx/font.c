@@ -2,8 +2,7 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #define STBTT_STATIC
 
-#include <cglm/struct.h>       // vec2s, vec3s
-#include <glad.h>              // GL*
+#include <cglm/struct.h>       // vec2s, vec3s, vec4s
 #include <stb/stb_rect_pack.h> // Used by stb_truetype.h
 #include <stb/stb_truetype.h>  // stbtt_*
 #include <stdarg.h>            // va_list, va_start, va_end
@@ -13,18 +12,27 @@
 #include "../main.h"
 #include "../util.h"
 #include "font.h"
-#include "gfx.h"
+#include "queue.h"
 #include "sprite.h"
 #include "rend.h"
-#include "shader.h"
-#include "tex.h"
-
-// Constants
-static const unsigned FONT_QUAD_COUNT = 200; // Max amount of letter sprites
 
 // Function definitions
 
-Font font_load(float height, const char* file)
+// Start packing fonts into width by height pixels
+void font_beginPack(FontPack* p, int width, int height)
+{
+    p->width  = width;
+    p->height = height;
+    p->bitmap = (unsigned char*) malloc((size_t) width * height);
+    if (!p->bitmap) main_term(EXIT_FAILURE, "Could not allocate the font bitmap.\n");
+    if (!stbtt_PackBegin(&p->ctx, p->bitmap, width, height, 0, 1, NULL)) {
+        main_term(EXIT_FAILURE, "stbtt_PackBegin failed.\n");
+    }
+}
+
+/* Pack the glyphs of a font next to those already in p. The layer is
+ * texWidth by texHeight, the pack sits in its top left. */
+Font font_load(FontPack* p, float height, const char* file, float layer, int texWidth, int texHeight)
 {
     unsigned char* data = (unsigned char*) util_load(file, READ_ONLY_BIN);
     if (!data) main_term(EXIT_FAILURE, "Unable to load font: \n%s\n", file);
@@ -32,49 +40,48 @@ Font font_load(float height, const char* file)
         main_term(EXIT_FAILURE, "Loaded font does not contain valid data:\n%s\n", file);
     }
 
-    unsigned char* bitmap = (unsigned char*) malloc(SCR_WIDTH * SCR_HEIGHT * sizeof(unsigned char));
-
     Font f;
-    stbtt_pack_context ctx;
-    if (!stbtt_PackBegin(&ctx, bitmap, SCR_WIDTH, SCR_HEIGHT, 0, 1, NULL)) {
-        main_term(EXIT_FAILURE, "stbtt_PackBegin failed.\n");
+    if (!stbtt_PackFontRange(&p->ctx, data, 0, height, ASCII_FIRST, ASCII_COUNT, f.chars)) {
+        main_term(EXIT_FAILURE, "Fonts do not fit in %ix%i pixels.\n", p->width, p->height);
     }
-    stbtt_PackFontRange(&ctx, data, 0, height, ASCII_FIRST, ASCII_COUNT, f.chars);
-    stbtt_PackEnd(&ctx);
 
     util_unload((char*) data);
 
-    f.size     = height;
-    f.rend     = rend_create(FONT_QUAD_COUNT);
-    f.rend.tex = tex_create(GL_R8, SCR_WIDTH, SCR_HEIGHT, GL_RED, (const void*) bitmap);
-
-    free(bitmap);
+    f.size      = height;
+    f.layer     = layer;
+    f.texWidth  = texWidth;
+    f.texHeight = texHeight;
 
     return f;
 }
 
-void font_unload(Font f)
-{
-    rend_unload(f.rend);
-}
-
-void font_begin(Font f, vec3s col)
+/* Finish the pack into pixels, RGBA of the pack's size. Glyphs are white with
+ * their coverage in alpha, so the fonts draw and are tinted like any other
+ * sprite. */
+void font_endPack(FontPack* p, unsigned char* pixels)
 {
-    Shader s = gfx_getShader();
-    shader_setTex(s, f.rend.tex.unit);
-    shader_setIsFont(s, true);
-    shader_setCol(s, col);
+    stbtt_PackEnd(&p->ctx);
+
+    size_t texels = (size_t) p->width * p->height;
+    for (size_t i = 0; i < texels; i++) {
+        pixels[i * 4 + 0] = 255;
+        pixels[i * 4 + 1] = 255;
+        pixels[i * 4 + 2] = 255;
+        pixels[i * 4 + 3] = p->bitmap[i];
+    }
+    free(p->bitmap);
+    p->bitmap = nullptr;
 }
 
-void font_printf(Font* f, vec2s pos, const char* fmt, ...)
+void font_printf(Font* f, Rend* r, int layer, vec2s pos, vec3s col, const char* fmt, ...)
 {
     va_list args;
     va_start(args, fmt);
-    font_vprintf(f, pos, fmt, args);
+    font_vprintf(f, r, layer, pos, col, fmt, args);
     va_end(args);
 }
 
-void font_vprintf(Font* f, vec2s pos, const char* fmt, va_list args)
+void font_vprintf(Font* f, Rend* r, int layer, vec2s pos, vec3s col, const char* fmt, va_list args)
 {
     va_list ap;
     va_copy(ap, args);
@@ -92,28 +99,15 @@ void font_vprintf(Font* f, vec2s pos, const char* fmt, va_list args)
         } else {
             int j = text[i] - ASCII_FIRST;
             stbtt_aligned_quad quad;
-            stbtt_GetPackedQuad(&f->chars[0], SCR_WIDTH, SCR_HEIGHT, j, &pos.x, &pos.y, &quad, 0);
-
-            // Convert to our sprite
-            float x1 = quad.x0; float y1 = quad.y0;
-            float u1 = quad.s0; float v1 = quad.t0;
-            float x2 = quad.x1; float y2 = quad.y1;
-            float u2 = quad.s1; float v2 = quad.t1;
-	    // rend_sprite doesn't use .size
-            Sprite sprite = {
-                .verts = {
-                    { {{ x1, y1 }}, {{ u1, v1 }} },
-                    { {{ x2, y1 }}, {{ u2, v1 }} },
-                    { {{ x2, y2 }}, {{ u2, v2 }} },
-                    { {{ x1, y2 }}, {{ u1, v2 }} }
-                }
-            };
-            rend_sprite(&f->rend, sprite);
+            stbtt_GetPackedQuad(&f->chars[0], f->texWidth, f->texHeight, j, &pos.x, &pos.y, &quad, 0);
+
+            // An instance spans its size less one, so the far edges land on x1 and y1
+            Instance* inst = queue_instance(layer, r);
+            inst->pos   = (vec2s) {{ quad.x0, quad.y0 }};
+            inst->size  = (vec2s) {{ quad.x1 - quad.x0 + 1, quad.y1 - quad.y0 + 1 }};
+            inst->uv    = (vec4s) {{ quad.s0, quad.t0, quad.s1, quad.t1 }};
+            inst->layer = f->layer;
+            inst->col   = col;
         }
     }
 }
-
-void font_end(Font* f)
-{
-    rend_end(&f->rend);
-}
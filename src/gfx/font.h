@@ -2,7 +2,7 @@
 #undef STB_TRUETYPE_IMPLEMENTATION
 
 #include <cglm/struct.h>      // vec2s, vec3s
-#include <stb/stb_truetype.h> // stbtt_packedchar
+#include <stb/stb_truetype.h> // stbtt_packedchar, stbtt_pack_context
 #include <stdarg.h>           // va_list
 #include <stdlib.h>           // size_t
 
@@ -16,14 +16,23 @@ constexpr size_t ASCII_COUNT = ASCII_LAST + 1 - ASCII_FIRST;
 // Types
 typedef struct {
     float size;
-    Rend  rend;
+    float layer;     // Of the atlas
+    int   texWidth;  // Of the atlas layers
+    int   texHeight;
     stbtt_packedchar chars[ASCII_COUNT];
 } Font;
 
+// Fonts packed together into the top left of one atlas layer
+typedef struct {
+    stbtt_pack_context ctx;
+    unsigned char*     bitmap; // Coverage of the glyphs
+    int                width;
+    int                height;
+} FontPack;
+
 // Function prototypes
-Font font_load(float height, const char* file);
-void font_unload(Font f);
-void font_begin(Font f, vec3s col);
-void font_printf(Font* f, vec2s pos, const char* fmt, ...);
-void font_vprintf(Font* f, vec2s pos, const char* fmt, va_list args);
-void font_end(Font* f);
+void font_beginPack(FontPack* p, int width, int height);
+Font font_load(FontPack* p, float height, const char* file, float layer, int texWidth, int texHeight);
+void font_endPack(FontPack* p, unsigned char* pixels);
+void font_printf(Font* f, Rend* r, int layer, vec2s pos, vec3s col, const char* fmt, ...);
+void font_vprintf(Font* f, Rend* r, int layer, vec2s pos, vec3s col, const char* fmt, va_list args);
@@ -8,12 +8,15 @@
 #include <glad.h>        // gl*, GL*
 #ifndef NDEBUG
 #include <stb/stb_image_write.h>
+#include <stdio.h>       // printf
 #include <stdlib.h>      // malloc, free
 #endif
 
 #include "../main.h"
 #include "gfx.h"
 #include "shader.h"
+#include "soft.h"
+#include "timer.h"
 
 // Function prototypes
 #ifndef NDEBUG
@@ -33,9 +36,17 @@ static const int NUM_CHANNELS  = 3;
 #endif // !NDEBUG
 static const char SHADER_VERT[] = "shader/vert.glsl";
 static const char SHADER_FRAG[] = "shader/frag.glsl";
+constexpr GLenum UNIT_MAX = 32; // Texture units tracked, binds to any others always go through
 
 // Variables
-static Shader shader;
+static Shader    shader;
+static GLuint    bound[UNIT_MAX]; // Texture on each unit
+static GLenum    activeUnit;
+static GfxStates current;         // Frame in progress
+static GfxStates session;
+static long      frameCount;
+static GLuint    fbo;             // Offscreen target and its colour buffer, when headless
+static GLuint    rbo;
 
 // Function definitions
 
@@ -86,6 +97,18 @@ void gfx_screenshot(void)
     }
 }
 
+void gfx_printStates(void)
+{
+    double changes = frameCount ? (double) session.changes / frameCount : 0.0;
+    double skips   = frameCount ? (double) session.skips / frameCount : 0.0;
+    double draws   = frameCount ? (double) session.draws / frameCount : 0.0;
+    printf("GL state over %li frames\n", frameCount);
+    printf("%-18s %12s %12s\n", "", "Total", "Per frame");
+    printf("%-18s %12li %12.1f\n", "Changes", session.changes, changes);
+    printf("%-18s %12li %12.1f\n", "Skipped", session.skips, skips);
+    printf("%-18s %12li %12.1f\n", "Draws", session.draws, draws);
+}
+
 #endif // !NDEBUG
 
 void gfx_init(void)
@@ -104,13 +127,41 @@ void gfx_init(void)
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
     shader = shader_load(SHADER_VERT, SHADER_FRAG);
-    shader_use(shader);
     gfx_resize(SCR_WIDTH, SCR_HEIGHT);
+#ifdef SOFT_REND
+    soft_init();
+#endif
+
+    timer_init();
 }
 
 void gfx_term(void)
 {
-    shader_unload(shader);
+    timer_term();
+#ifdef SOFT_REND
+    soft_term();
+#endif
+    if (fbo) {
+        glDeleteFramebuffers(1, &fbo);
+        glDeleteRenderbuffers(1, &rbo);
+    }
+    shader_unload(&shader);
+}
+
+// Draw into a framebuffer of the screen size, for when there is no window
+void gfx_initOffscreen(void)
+{
+    glGenRenderbuffers(1, &rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT);
+
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, rbo);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        main_term(EXIT_FAILURE, "Could not create the offscreen framebuffer.\n");
+    }
+    gfx_resize(SCR_WIDTH, SCR_HEIGHT);
 }
 
 void gfx_resize(int width, int height)
@@ -119,16 +170,64 @@ void gfx_resize(int width, int height)
 
     // Using origin top left to match coords typically used with images
     mat4s proj = glms_ortho(0.0f, width, height, 0.0f, -1.0f, 1.0f);
-    shader_setProj(shader, proj);
+    shader_setProj(&shader, proj);
 }
 
 void gfx_clear(vec3s col)
 {
+#ifdef SOFT_REND
+    soft_clear(col);
+#else
     glClearColor(col.r, col.g, col.b, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+#endif
+}
+
+Shader* gfx_getShader(void)
+{
+    return &shader;
+}
+
+// Bind a texture array, skipped if it's already bound to the unit
+void gfx_bindTex(GLenum unit, GLuint name)
+{
+    bool isTracked = unit < UNIT_MAX;
+    bool isChanged = !isTracked || bound[unit] != name;
+    gfx_countState(isChanged);
+    if (!isChanged) return;
+
+    if (activeUnit != unit) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        activeUnit = unit;
+    }
+    glBindTexture(GL_TEXTURE_2D_ARRAY, name);
+    if (isTracked) bound[unit] = name;
+}
+
+// Called by the trackers for each state change asked for
+void gfx_countState(bool isChanged)
+{
+    if (isChanged) {
+        current.changes++;
+    } else {
+        current.skips++;
+    }
 }
 
-Shader gfx_getShader(void)
+void gfx_countDraw(void)
 {
-    return shader;
+    current.draws++;
+}
+
+void gfx_endFrame(void)
+{
+#ifdef SOFT_REND
+    soft_present();
+#endif
+    session.changes += current.changes;
+    session.skips   += current.skips;
+    session.draws   += current.draws;
+    current = (GfxStates) {};
+    frameCount++;
+    timer_endFrame();
 }
@@ -4,12 +4,27 @@
 
 #include "shader.h"
 
+// Types
+
+// GL state changes made and skipped because the state was already in place
+typedef struct {
+    long changes;
+    long skips;
+    long draws;
+} GfxStates;
+
 // Function prototypes
 #ifndef NDEBUG
-void   gfx_screenshot(void);
+void      gfx_screenshot(void);
+void      gfx_printStates(void);
 #endif
-void   gfx_init(void);
-void   gfx_term(void);
-void   gfx_resize(int width, int height);
-void   gfx_clear(vec3s col);
-Shader gfx_getShader(void);
+void      gfx_init(void);
+void      gfx_term(void);
+void      gfx_initOffscreen(void);
+void      gfx_resize(int width, int height);
+void      gfx_clear(vec3s col);
+Shader*   gfx_getShader(void);
+void      gfx_bindTex(GLenum unit, GLuint name);
+void      gfx_countState(bool isChanged);
+void      gfx_countDraw(void);
+void      gfx_endFrame(void);
@@ -0,0 +1,275 @@
+/*
+ * Render queue. Sprites, text and slots are submitted during the frame with a
+ * layer, in any order, and drawn by queue_draw() sorted by layer and then by
+ * material, the texture of their renderer. Within a layer and material they
+ * keep the order they were submitted in, there is no order between materials
+ * in a layer. Each run of one material is drawn as one batch, so the number
+ * of draws depends on the layers and materials used and not on the order of
+ * the calls.
+ *
+ * Only the sort keys are sorted, each holds the index of its item. A queue
+ * that fills up grows.
+ *
+ * A queued frame is a snapshot, so it can be drawn on another thread while
+ * the game queues the next. There are three: one being queued, the last
+ * published and one being drawn. queue_publish() and queue_take() swap the
+ * first two and the last two with one atomic exchange each, neither side
+ * waits for the other. Slot changes are copied into the frame, the game can
+ * change the slots again straight away.
+ */
+
+#include <cglm/struct.h> // vec3s
+#include <stdatomic.h>   // atomic_int, atomic_load, atomic_exchange
+#include <stdint.h>      // uint64_t
+#include <stdlib.h>      // size_t, malloc, realloc, free, qsort
+#include <string.h>      // memcpy, memset
+
+#include "../main.h"
+#include "../util.h"
+#include "gfx.h"
+#include "queue.h"
+#include "rend.h"
+#include "timer.h"
+
+// Types
+typedef struct {
+    Rend*  rend;
+    Slots* slots; // Drawn instead of inst when set
+    union
+    {
+        Instance inst;
+        struct {
+            size_t range;      // First of the slots' ranges, in the frame's ranges
+            size_t rangeCount; // Runs of blocks changed since the last frame
+        };
+    };
+} Item;
+
+typedef struct {
+    Item*      items;
+    uint64_t*  keys;
+    size_t     capacity;
+    size_t     count;
+    Instance*  changes;       // Copies of changed slots
+    size_t     changeCapacity;
+    size_t     changeCount;
+    SlotRange* ranges;        // Where each run of changes goes
+    size_t     rangeCapacity;
+    size_t     rangeCount;
+    vec3s      clearCol;
+    bool       isClear;
+} Frame;
+
+// Function prototypes
+static int      compareKeys(const void* a, const void* b);
+static uint64_t getMaterial(uint64_t key);
+static void*    resize(void* p, size_t count, size_t size);
+static Item*    add(int layer, Rend* r);
+static bool     isBlockDirty(const Slots* s, size_t block);
+static void     addRange(Frame* f, const Slots* s, size_t first, size_t last);
+
+// Constants
+constexpr int      LAYER_SHIFT    = 56; // Layer in the top byte of a key
+constexpr int      MATERIAL_SHIFT = 32; // Then the material, then the item index
+constexpr uint64_t MATERIAL_MASK  = 0xffffff;
+constexpr uint64_t INDEX_MASK     = 0xffffffff;
+constexpr int      FRAME_COUNT    = 3;
+constexpr int      FRESH          = 4;  // Set on the published frame until it's taken
+
+// Variables
+static Frame      frames[FRAME_COUNT];
+static int        back  = 0; // Being queued
+static atomic_int ready = 1; // Last published, with FRESH
+static int        front = 2; // Being drawn
+
+// Function definitions
+
+int compareKeys(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a;
+    uint64_t y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+uint64_t getMaterial(uint64_t key)
+{
+    return key >> MATERIAL_SHIFT & MATERIAL_MASK;
+}
+
+void* resize(void* p, size_t count, size_t size)
+{
+    p = realloc(p, count * size);
+    if (!p) main_term(EXIT_FAILURE, "Could not grow the render queue.\n");
+    return p;
+}
+
+Item* add(int layer, Rend* r)
+{
+    Frame* f = &frames[back];
+    if (f->count == f->capacity) {
+        f->capacity *= 2;
+        f->items     = (Item*) resize(f->items, f->capacity, sizeof(Item));
+        f->keys      = (uint64_t*) resize(f->keys, f->capacity, sizeof(uint64_t));
+    }
+
+    uint64_t material = r->tex.unit;
+    f->keys[f->count] = (uint64_t) layer << LAYER_SHIFT | material << MATERIAL_SHIFT | f->count;
+
+    Item* it = &f->items[f->count++];
+    it->rend  = r;
+    it->slots = nullptr;
+    return it;
+}
+
+bool isBlockDirty(const Slots* s, size_t block)
+{
+    return s->dirty[block / 64] >> block % 64 & 1;
+}
+
+// Copy the slots first to last into the frame's changes
+void addRange(Frame* f, const Slots* s, size_t first, size_t last)
+{
+    size_t n = last - first;
+    if (f->changeCount + n > f->changeCapacity) {
+        f->changeCapacity = MAX(f->changeCapacity * 2, f->changeCount + n);
+        f->changes        = (Instance*) resize(f->changes, f->changeCapacity, sizeof(Instance));
+    }
+    if (f->rangeCount == f->rangeCapacity) {
+        f->rangeCapacity = MAX(f->rangeCapacity * 2, 16);
+        f->ranges        = (SlotRange*) resize(f->ranges, f->rangeCapacity, sizeof(SlotRange));
+    }
+
+    f->ranges[f->rangeCount++] = (SlotRange) { first, last, f->changeCount };
+    memcpy(f->changes + f->changeCount, s->instances + first, sizeof(Instance) * n);
+    f->changeCount += n;
+}
+
+void queue_init(size_t size)
+{
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        Frame* f    = &frames[i];
+        f->capacity = size;
+        f->items    = (Item*) malloc(sizeof(Item) * size);
+        f->keys     = (uint64_t*) malloc(sizeof(uint64_t) * size);
+        if (!f->items || !f->keys) main_term(EXIT_FAILURE, "Could not allocate the render queue.\n");
+    }
+}
+
+void queue_term(void)
+{
+    for (int i = 0; i < FRAME_COUNT; i++) {
+        free(frames[i].items);
+        free(frames[i].keys);
+        free(frames[i].changes);
+        free(frames[i].ranges);
+    }
+}
+
+// Clear the screen before the frame is drawn
+void queue_clear(vec3s col)
+{
+    frames[back].clearCol = col;
+    frames[back].isClear  = true;
+}
+
+// Space for one instance, to be filled in by the caller
+Instance* queue_instance(int layer, Rend* r)
+{
+    return &add(layer, r)->inst;
+}
+
+void queue_sprite(int layer, Rend* r, const Sprite* s)
+{
+    add(layer, r)->inst = sprite_toInstance(s);
+}
+
+/* The slots use r's texture and are drawn in r's batch. Their changes are
+ * taken into the frame, each run of changed blocks as one range, so changes
+ * far apart do not send the slots between them. */
+void queue_slots(int layer, Rend* r, Slots* s)
+{
+    Item*  it = add(layer, r);
+    Frame* f  = &frames[back];
+    it->slots      = s;
+    it->range      = f->rangeCount;
+    it->rangeCount = 0;
+
+    size_t blocks = (s->count + SLOT_BLOCK - 1) / SLOT_BLOCK;
+    for (size_t b = 0; b < blocks;) {
+        if (!isBlockDirty(s, b)) {
+            b++;
+            continue;
+        }
+        size_t end = b + 1;
+        while (end < blocks && isBlockDirty(s, end)) end++;
+
+        addRange(f, s, b * SLOT_BLOCK, MIN(end * SLOT_BLOCK, s->count));
+        it->rangeCount++;
+        b = end;
+    }
+    memset(s->dirty, 0, sizeof(uint64_t) * s->dirtyWords);
+}
+
+/* Hand the frame queued over to be drawn and start the next. A frame still
+ * not taken is replaced, its slot changes go again in full with the next one
+ * so they are at most a frame late. */
+void queue_publish(void)
+{
+    int old = atomic_exchange(&ready, back | FRESH);
+    back    = old & ~FRESH;
+
+    Frame* f = &frames[back];
+    if (old & FRESH) {
+        for (size_t i = 0; i < f->count; i++) {
+            Slots* s = f->items[i].slots;
+            if (s) memset(s->dirty, 0xff, sizeof(uint64_t) * s->dirtyWords);
+        }
+    }
+    f->count       = 0;
+    f->changeCount = 0;
+    f->rangeCount  = 0;
+    f->isClear     = false;
+}
+
+// A frame is published and not yet taken
+bool queue_isPending(void)
+{
+    return atomic_load(&ready) & FRESH;
+}
+
+// Take the last frame published to be drawn, false if there is none new
+bool queue_take(void)
+{
+    if (!queue_isPending()) return false;
+    front = atomic_exchange(&ready, front) & ~FRESH;
+    return true;
+}
+
+// Draw the frame taken, on the thread with the GL context
+void queue_draw(void)
+{
+    Frame* f = &frames[front];
+    if (f->isClear) gfx_clear(f->clearCol);
+
+    qsort(f->keys, f->count, sizeof(f->keys[0]), compareKeys);
+
+    for (size_t i = 0; i < f->count;) {
+        uint64_t material = getMaterial(f->keys[i]);
+        Rend*    r        = f->items[f->keys[i] & INDEX_MASK].rend;
+
+        // Layers next to each other with the same material merge too, the run
+        // is timed as its first layer
+        timer_begin(f->keys[i] >> LAYER_SHIFT);
+        rend_begin(*r);
+        for (; i < f->count && getMaterial(f->keys[i]) == material; i++) {
+            Item* it = &f->items[f->keys[i] & INDEX_MASK];
+            if (it->slots) {
+                rend_slots(r, it->slots, f->ranges + it->range, it->rangeCount, f->changes);
+            } else {
+                *rend_instance(r) = it->inst;
+            }
+        }
+        rend_end(r);
+        timer_end();
+    }
+}
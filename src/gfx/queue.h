@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cglm/struct.h> // vec3s
+#include <stdlib.h>      // size_t
+
+#include "rend.h"
+#include "sprite.h"
+
+// Function prototypes
+void      queue_init(size_t size);
+void      queue_term(void);
+void      queue_clear(vec3s col);
+Instance* queue_instance(int layer, Rend* r);
+void      queue_sprite(int layer, Rend* r, const Sprite* s);
+void      queue_slots(int layer, Rend* r, Slots* s);
+void      queue_publish(void);
+bool      queue_isPending(void);
+bool      queue_take(void);
+void      queue_draw(void);
@@ -1,53 +1,116 @@
-#include <stdlib.h> // size_t
+/*
+ * Batched sprite renderer. Sprites are written straight into a mapped
+ * region of the vertex buffer, with no staging copy. Each flush draws its
+ * region and moves on to the next one in a ring, so the region just drawn is
+ * not written again until its fence shows the GPU is done with it. The
+ * regions are mapped unsynchronised, the fences do the syncing, so the
+ * driver never has to stall on a buffer the GPU is reading.
+ *
+ * Sprites are sent as instances, the vertex shader makes the corners from
+ * gl_VertexID so no indices are needed.
+ *
+ * Colour is carried per instance, so sprites and text of any colour share a
+ * batch.
+ *
+ * Sprites that rarely change, like the bricks, can instead be kept in slots
+ * on the GPU and drawn with one call, only the changed slots are uploaded.
+ *
+ * Built with SOFT_REND, the same interface draws on the CPU with soft.c. The
+ * regions are then plain memory and each flush rasterises its sprites.
+ */
 
+#include <stdint.h> // uint64_t
+#include <stdlib.h> // size_t, malloc, calloc, free
+#include <string.h> // memcpy
+
+#include "../main.h"
 #include "../util.h"
 #include "gfx.h"
 #include "rend.h"
 #include "shader.h"
+#include "soft.h"
 #include "tex.h"
 
+// Function prototypes
+#ifndef SOFT_REND
+static void  createInstances(void);
+static void  pointInstances(size_t offset);
+#endif
+static void  markSlot(Slots* s, size_t i);
+static void* reserve(Rend* r, size_t size);
+static void  mapRegion(Rend* r);
+static void  flush(Rend* r);
+
 // Constants
-static const GLushort QUAD_INDICES[] = { 0, 1, 2, 0, 2, 3 };
+#ifndef SOFT_REND
+static const GLuint64 FENCE_TIMEOUT  = 1000000; // Nanoseconds between checks on a fence
+static const GLuint   ATTR_RECT      = 2; // Instance position and size
+static const GLuint   ATTR_UV        = 3; // Instance texture coordinates
+static const GLuint   ATTR_LAYER     = 4; // Instance texture array layer
+static const GLuint   ATTR_COL       = 5; // Instance tint
+#endif
 
 // Function definitions
 
+#ifdef SOFT_REND
+
 Rend rend_create(size_t count)
 {
-    Rend r;
-    r.vertMax      = count * VERT_COUNT;
-    size_t qiCount = COUNT(QUAD_INDICES);
-    size_t viCount  = count * qiCount;
-    size_t viSize   = sizeof(GLushort) * viCount;
+    Rend r = {};
+    r.regionSize = count * sizeof(Instance);
+    return r;
+}
 
-    // Pre-calculate the entire index buffer
-    r.indices = (GLushort*) malloc(viSize);
-    for (size_t i = 0; i < viCount; i++) {
-        r.indices[i] = i / qiCount * VERT_COUNT + QUAD_INDICES[i % qiCount];
-    }
+#else
+
+// The pointers are set per flush, to the region drawn
+void createInstances(void)
+{
+    glEnableVertexAttribArray(ATTR_RECT);
+    glVertexAttribDivisor(ATTR_RECT, 1);
+
+    glEnableVertexAttribArray(ATTR_UV);
+    glVertexAttribDivisor(ATTR_UV, 1);
+
+    glEnableVertexAttribArray(ATTR_LAYER);
+    glVertexAttribDivisor(ATTR_LAYER, 1);
+
+    glEnableVertexAttribArray(ATTR_COL);
+    glVertexAttribDivisor(ATTR_COL, 1);
+}
+
+// Point the instance attributes at the instances from offset in the bound buffer
+void pointInstances(size_t offset)
+{
+    glVertexAttribPointer(ATTR_RECT, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            (void*) (offset + offsetof(Instance, pos)));
+    glVertexAttribPointer(ATTR_UV, 4, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            (void*) (offset + offsetof(Instance, uv)));
+    glVertexAttribPointer(ATTR_LAYER, 1, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            (void*) (offset + offsetof(Instance, layer)));
+    glVertexAttribPointer(ATTR_COL, 3, GL_FLOAT, GL_FALSE, sizeof(Instance),
+            (void*) (offset + offsetof(Instance, col)));
+}
+
+Rend rend_create(size_t count)
+{
+    Rend r = {};
+    r.regionSize = count * sizeof(Instance);
 
     glGenVertexArrays(1, &r.vao);
     glBindVertexArray(r.vao);
 
     glGenBuffers(1, &r.vbo);
     glBindBuffer(GL_ARRAY_BUFFER, r.vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vert) * r.vertMax, NULL, GL_DYNAMIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, r.regionSize * RING_COUNT, NULL, GL_STREAM_DRAW);
 
-    glGenBuffers(1, &r.ebo);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r.ebo);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, viSize, r.indices, GL_STATIC_DRAW);
-
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, IND_COUNT, GL_FLOAT, GL_FALSE, sizeof(Vert), (void*) offsetof(Vert, pos));
-
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, IND_COUNT, GL_FLOAT, GL_FALSE, sizeof(Vert), (void*) offsetof(Vert, texCoord));
-
-    r.vertCount = 0;
-    r.verts = (Vert*) malloc(sizeof(Vert) * r.vertMax);
+    createInstances();
 
     return r;
 }
 
+#endif // SOFT_REND
+
 Rend rend_load(size_t count, const char* file)
 {
     Rend r = rend_create(count);
@@ -55,54 +118,234 @@ Rend rend_load(size_t count, const char* file)
     return r;
 }
 
+#ifdef SOFT_REND
+
+void rend_unload(Rend r)
+{
+    tex_unload(r.tex);
+    free(r.mapped);
+}
+
+void rend_begin([[maybe_unused]] Rend r)
+{
+}
+
+// The one region is kept from the first sprite on
+void mapRegion(Rend* r)
+{
+    r->mapped = (char*) malloc(r->regionSize);
+    if (!r->mapped) main_term(EXIT_FAILURE, "Could not allocate the sprite buffer.\n");
+}
+
+void flush(Rend* r)
+{
+    if (!r->used) return;
+
+    soft_draw(&r->tex, (const Instance*) r->mapped, r->used / sizeof(Instance));
+    gfx_countDraw();
+    r->used = 0;
+}
+
+#else
+
 void rend_unload(Rend r)
 {
     tex_unload(r.tex);
-    if (r.verts)   free(r.verts);
-    if (r.indices) free(r.indices);
-    glDeleteBuffers(1, &r.ebo);
+    if (r.mapped) {
+        glBindBuffer(GL_ARRAY_BUFFER, r.vbo);
+        glUnmapBuffer(GL_ARRAY_BUFFER);
+    }
+    for (size_t i = 0; i < RING_COUNT; i++) {
+        if (r.fences[i]) glDeleteSync(r.fences[i]);
+    }
     glDeleteBuffers(1, &r.vbo);
     glDeleteVertexArrays(1, &r.vao);
 }
 
 void rend_begin(Rend r)
 {
-    Shader s = gfx_getShader();
+    Shader* s = gfx_getShader();
     shader_setTex(s, r.tex.unit);
-    shader_setCol(s, (vec3s) {{ 1.0f, 1.0f, 1.0f }});
-    shader_setIsFont(s, false);
+}
+
+// Wait until the GPU has finished with the current region and map it
+void mapRegion(Rend* r)
+{
+    GLsync fence = r->fences[r->region];
+    if (fence) {
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        } while (status == GL_TIMEOUT_EXPIRED);
+        glDeleteSync(fence);
+        r->fences[r->region] = nullptr;
+        if (status == GL_WAIT_FAILED) main_term(EXIT_FAILURE, "Vertex buffer fence wait failed.\n");
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, r->vbo);
+    r->mapped = (char*) glMapBufferRange(GL_ARRAY_BUFFER, r->regionSize * r->region, r->regionSize,
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT |
+            GL_MAP_FLUSH_EXPLICIT_BIT);
+    if (!r->mapped) main_term(EXIT_FAILURE, "Could not map the vertex buffer.\n");
 }
 
 void flush(Rend* r)
 {
-    if (!r->vertCount) return;
+    if (!r->used) return;
 
+    // Only the bytes written need to reach the GPU
     glBindBuffer(GL_ARRAY_BUFFER, r->vbo);
-    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(Vert) * r->vertCount,
-            r->verts);
+    glFlushMappedBufferRange(GL_ARRAY_BUFFER, 0, r->used);
+    bool isIntact = glUnmapBuffer(GL_ARRAY_BUFFER);
+    r->mapped = nullptr;
 
-    glBindVertexArray(r->vao);
-    GLsizei count = r->vertCount / VERT_COUNT * COUNT(QUAD_INDICES);
-    glDrawElements(GL_TRIANGLES, count, GL_UNSIGNED_SHORT, 0);
+    // The contents are undefined if the buffer was lost, skip a frame's batch
+    if (isIntact) {
+        glBindVertexArray(r->vao);
+        size_t offset = r->regionSize * r->region;
+        pointInstances(offset);
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, VERT_COUNT, r->used / sizeof(Instance));
+        gfx_countDraw();
+        r->fences[r->region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
 
-    r->vertCount = 0;
+    r->region = (r->region + 1) % RING_COUNT;
+    r->used   = 0;
 }
 
+#endif // SOFT_REND
+
 void rend_end(Rend* r)
 {
     flush(r);
 }
 
-void rend_sprite(Rend* r, Sprite s)
+// Space for size bytes in the current region, flushing first if it's full
+void* reserve(Rend* r, size_t size)
 {
-    if (r->vertCount == r->vertMax) {
+    if (r->used + size > r->regionSize) {
 #ifndef NDEBUG
         fprintf(stderr, "%s\n", "Warning: flushed full vertex cache.");
 #endif // !NDEBUG
         flush(r);
     }
+    if (!r->mapped) mapRegion(r);
+
+    void* p = r->mapped + r->used;
+    r->used += size;
+    return p;
+}
+
+/* Space for one instance in the vertex buffer, to be filled in by the
+ * caller. The memory is write only, reading it back can be very slow. */
+Instance* rend_instance(Rend* r)
+{
+    return (Instance*) reserve(r, sizeof(Instance));
+}
+
+#ifdef SOFT_REND
+
+Slots rend_createSlots(size_t count)
+{
+    Slots s = {};
+    s.count      = count;
+    s.instances  = (Instance*) calloc(count, sizeof(Instance));
+    s.dirtyWords = (count + SLOT_BLOCK * 64 - 1) / (SLOT_BLOCK * 64);
+    s.dirty      = (uint64_t*) calloc(s.dirtyWords, sizeof(uint64_t));
+    s.drawn      = (Instance*) calloc(count, sizeof(Instance));
+    return s;
+}
+
+void rend_unloadSlots(Slots s)
+{
+    if (s.instances) free(s.instances);
+    if (s.dirty) free(s.dirty);
+    if (s.drawn) free(s.drawn);
+}
+
+#else
+
+Slots rend_createSlots(size_t count)
+{
+    Slots s = {};
+    s.count      = count;
+    s.instances  = (Instance*) calloc(count, sizeof(Instance));
+    s.dirtyWords = (count + SLOT_BLOCK * 64 - 1) / (SLOT_BLOCK * 64);
+    s.dirty      = (uint64_t*) calloc(s.dirtyWords, sizeof(uint64_t));
+
+    glGenVertexArrays(1, &s.vao);
+    glBindVertexArray(s.vao);
 
-    for (size_t i = 0; i < VERT_COUNT; i++) {
-        r->verts[r->vertCount++] = s.verts[i];
+    glGenBuffers(1, &s.vbo);
+    glBindBuffer(GL_ARRAY_BUFFER, s.vbo);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Instance) * count, s.instances, GL_DYNAMIC_DRAW);
+
+    createInstances();
+    pointInstances(0);
+
+    return s;
+}
+
+void rend_unloadSlots(Slots s)
+{
+    if (s.instances) free(s.instances);
+    if (s.dirty) free(s.dirty);
+    glDeleteBuffers(1, &s.vbo);
+    glDeleteVertexArrays(1, &s.vao);
+}
+
+#endif // SOFT_REND
+
+void markSlot(Slots* s, size_t i)
+{
+    size_t block = i / SLOT_BLOCK;
+    s->dirty[block / 64] |= UINT64_C(1) << block % 64;
+}
+
+void rend_setSlot(Slots* s, size_t i, Instance inst)
+{
+    s->instances[i] = inst;
+    markSlot(s, i);
+}
+
+void rend_clearSlot(Slots* s, size_t i)
+{
+    s->instances[i] = (Instance) {};
+    markSlot(s, i);
+}
+
+#ifdef SOFT_REND
+
+void rend_slots(Rend* r, Slots* s, const SlotRange* ranges, size_t count, const Instance* changes)
+{
+    flush(r);
+    for (size_t i = 0; i < count; i++) {
+        const SlotRange* sr = &ranges[i];
+        memcpy(s->drawn + sr->first, changes + sr->change, sizeof(Instance) * (sr->last - sr->first));
     }
+    soft_draw(&r->tex, s->drawn, s->count);
+    gfx_countDraw();
 }
+
+#else
+
+/* Upload the ranges of changes as the queue took them and draw the slots all
+ * in one call. The sprites already batched in r are drawn first, to keep the
+ * order, and the slots use r's texture. */
+void rend_slots(Rend* r, Slots* s, const SlotRange* ranges, size_t count, const Instance* changes)
+{
+    flush(r);
+
+    glBindBuffer(GL_ARRAY_BUFFER, s->vbo);
+    for (size_t i = 0; i < count; i++) {
+        const SlotRange* sr = &ranges[i];
+        glBufferSubData(GL_ARRAY_BUFFER, sizeof(Instance) * sr->first, sizeof(Instance) * (sr->last - sr->first),
+                changes + sr->change);
+    }
+
+    glBindVertexArray(s->vao);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, VERT_COUNT, s->count);
+    gfx_countDraw();
+}
+
+#endif // SOFT_REND
@@ -2,30 +2,63 @@
 #undef GLAD_GL_IMPLEMENTATION
 
 #include <glad.h>   // GL*
+#include <stdint.h> // uint64_t
 #include <stdlib.h> // size_t
 
 #include "sprite.h"
 #include "tex.h"
 
+// Constants
+constexpr size_t RING_COUNT = 3;  // Regions of the vertex buffer cycled through per flush
+constexpr size_t SLOT_BLOCK = 16; // Slots tracked and uploaded together when one changes
+
 // Types
+
+// Sprites are sent as Instances, expanded to quads by the vertex shader
 typedef struct {
-    // Vertex buffer data
+    // Vertex buffer data, a ring of RING_COUNT regions
     GLuint    vao;
     GLuint    vbo;
-    GLuint    ebo;
-    size_t    vertCount;
-    size_t    vertMax;
-    Vert*     verts;
-    GLushort* indices;
+    size_t    regionSize; // Bytes
+    size_t    used;       // Bytes written to the current region
+    char*     mapped;     // Current region while it is mapped, write only
+    size_t    region;
+    GLsync    fences[RING_COUNT]; // Set when the GPU may still be reading a region
 
     // One texture per renderer to minimise state changes
     Tex tex;
 } Rend;
 
+// Instances kept on the GPU between frames, a slot is only uploaded again
+// when it changes. An empty slot is all zeros and draws nothing. The game
+// sets the slots and the render queue takes the changes each frame, each run
+// of changed blocks as one range.
+typedef struct {
+    GLuint    vao;
+    GLuint    vbo;
+    Instance* instances;  // Copy of the buffer, as the game last set it
+    size_t    count;
+    uint64_t* dirty;      // Bit per block of SLOT_BLOCK slots changed since the last frame queued
+    size_t    dirtyWords;
+    Instance* drawn;      // Copy the software renderer draws from, SOFT_REND only
+} Slots;
+
+// Slots first to last changed, copied to change in the frame's changes
+typedef struct {
+    size_t first;
+    size_t last;
+    size_t change;
+} SlotRange;
+
 // Function prototypes
-Rend rend_create(size_t count);
-Rend rend_load(size_t count, const char* file);
-void rend_unload(Rend r);
-void rend_begin(Rend r);
-void rend_sprite(Rend* r, Sprite s);
-void rend_end(Rend* r);
+Rend      rend_create(size_t count);
+Rend      rend_load(size_t count, const char* file);
+void      rend_unload(Rend r);
+void      rend_begin(Rend r);
+Instance* rend_instance(Rend* r);
+void      rend_end(Rend* r);
+Slots     rend_createSlots(size_t count);
+void      rend_unloadSlots(Slots s);
+void      rend_setSlot(Slots* s, size_t i, Instance inst);
+void      rend_clearSlot(Slots* s, size_t i);
+void      rend_slots(Rend* r, Slots* s, const SlotRange* ranges, size_t count, const Instance* changes);
@@ -1,6 +1,7 @@
 #include <cglm/struct.h> // vec2s
 
 #include "../main.h"
+#include "queue.h"
 #include "rend.h"
 #include "screen.h"
 #include "sprite.h"
@@ -13,7 +14,7 @@ Screen screen_load(const char *file)
     vec2s pos  = {{ 0, 0 }};
     vec2s size = {{ SCR_WIDTH, SCR_HEIGHT }};
     s.rend     = rend_load(1, file);
-    s.sprite   = sprite_create(pos, size, pos, size);
+    s.sprite   = sprite_create(pos, size, sprite_uv(size, pos, size), 0.0f);
     return s;
 }
 
@@ -22,9 +23,7 @@ void screen_unload(Screen s)
     rend_unload(s.rend);
 }
 
-void screen_rend(Screen s)
+void screen_rend(Screen* s, int layer)
 {
-    rend_begin(s.rend);
-    rend_sprite(&s.rend, s.sprite);
-    rend_end(&s.rend);
+    queue_sprite(layer, &s->rend, &s->sprite);
 }
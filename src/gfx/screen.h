@@ -12,4 +12,4 @@ typedef struct {
 // Function prototypes
 Screen screen_load(const char* file);
 void   screen_unload(Screen s);
-void   screen_rend(Screen s);
+void   screen_rend(Screen* s, int layer);
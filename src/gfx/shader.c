@@ -1,10 +1,11 @@
 #undef GLAD_GL_IMPLEMENTATION
 
-#include <cglm/struct.h> // mat4s, vec3s
+#include <cglm/struct.h> // mat4s
 #include <glad.h>        // gl*, GL*
 
 #include "../main.h"
 #include "../util.h"
+#include "gfx.h"
 #include "shader.h"
 
 // Function prototypes
@@ -13,8 +14,9 @@ static void showLog(GLuint object, PFNGLGETSHADERIVPROC proc_param, PFNGLGETSHAD
 // Constants
 static const GLchar UNIFORM_PROJ[]    = "proj";
 static const GLchar UNIFORM_TEX[]     = "tex";
-static const GLchar UNIFORM_COL[]     = "col";
-static const GLchar UNIFORM_IS_FONT[] = "isFont";
+
+// Variables
+static GLuint current; // Program in use
 
 // Function definitions
 
@@ -71,40 +73,45 @@ Shader shader_load(const char* vert, const char* frag)
     }
 
     return (Shader) {
-        .prog       = prog,
-        .loc_proj   = glGetUniformLocation(prog, UNIFORM_PROJ),
-        .loc_tex    = glGetUniformLocation(prog, UNIFORM_TEX),
-        .loc_col    = glGetUniformLocation(prog, UNIFORM_COL),
-        .loc_isFont = glGetUniformLocation(prog, UNIFORM_IS_FONT)
+        .prog            = prog,
+        .loc_proj        = glGetUniformLocation(prog, UNIFORM_PROJ),
+        .loc_tex         = glGetUniformLocation(prog, UNIFORM_TEX),
+        .tex             = -1
     };
 }
 
-void shader_unload(Shader s)
+void shader_unload(Shader* s)
 {
-    glDeleteProgram(s.prog);
+    if (current == s->prog) current = 0;
+    glDeleteProgram(s->prog);
 }
 
-void shader_use(Shader s)
+/* Uniforms are set on the program in use, so the setters use theirs first.
+ * Binds and uniforms already in place are skipped and counted as such. */
+void shader_use(const Shader* s)
 {
-    glUseProgram(s.prog);
-}
+    bool isChanged = current != s->prog;
+    gfx_countState(isChanged);
+    if (!isChanged) return;
 
-void shader_setProj(Shader s, mat4s proj)
-{
-    glUniformMatrix4fv(s.loc_proj, 1, GL_FALSE, proj.raw[0]);
+    glUseProgram(s->prog);
+    current = s->prog;
 }
 
-void shader_setTex(Shader s, GLint tex)
+void shader_setProj(Shader* s, mat4s proj)
 {
-    glUniform1i(s.loc_tex, tex);
+    shader_use(s);
+    gfx_countState(true);
+    glUniformMatrix4fv(s->loc_proj, 1, GL_FALSE, proj.raw[0]);
 }
 
-void shader_setCol(Shader s, vec3s col)
+void shader_setTex(Shader* s, GLint tex)
 {
-    glUniform3f(s.loc_col, col.r, col.g, col.b);
-}
+    shader_use(s);
+    bool isChanged = s->tex != tex;
+    gfx_countState(isChanged);
+    if (!isChanged) return;
 
-void shader_setIsFont(Shader s, bool isFont)
-{
-    glUniform1i(s.loc_isFont, (GLint) isFont);
+    glUniform1i(s->loc_tex, tex);
+    s->tex = tex;
 }
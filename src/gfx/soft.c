@@ -0,0 +1,268 @@
+/*
+ * Software rasteriser, the renderer of SOFT_REND builds. Instances are drawn
+ * into a framebuffer in memory with the same coverage, texel choice and
+ * blending as the shaders, so frames can be compared against the GL path.
+ * Pixels are RGBA, one byte each, with the top row first.
+ *
+ * The texel column of each pixel of a sprite is worked out once, then each
+ * row gathers its texels and blends them 8 pixels at a time with AVX2, 4 with
+ * SSE2, or one at a time without either. Runs that are all transparent are
+ * skipped and runs that are all opaque and untinted are copied.
+ *
+ * Only the drawing is done on the CPU, a GL context is still needed:
+ * soft_present() uploads the framebuffer and blits it to the one bound, so
+ * the rest of the frame, swaps and screenshots, stays the same.
+ */
+
+#undef GLAD_GL_IMPLEMENTATION
+
+#include <cglm/struct.h> // vec3s
+#include <glad.h>        // gl*, GL*
+#include <math.h>        // ceilf, floorf
+#include <stdint.h>      // uint32_t
+#include <stdlib.h>      // size_t, malloc, free
+#if defined(__AVX2__)
+#include <immintrin.h>   // _mm256_*
+#elif defined(__SSE2__)
+#include <emmintrin.h>   // _mm_*
+#endif
+
+#include "../main.h"
+#include "../util.h"
+#include "soft.h"
+
+// Function prototypes
+static uint32_t toByte(float f);
+static uint32_t blendPixel(uint32_t src, uint32_t dst, const uint32_t tint[3]);
+static void     drawRow(uint32_t* dst, const uint32_t* texels, const int* cols, int count, const uint32_t tint[3],
+        bool isWhite);
+static void     drawInstance(const Tex* tex, const Instance* inst);
+
+// Constants
+static const uint32_t ALPHA = 0xff000000;
+
+// Variables
+static uint32_t* pixels; // SCR_WIDTH by SCR_HEIGHT
+static int*      cols;   // Texel column of each pixel of the sprite being drawn
+static GLuint    screen; // Pixels as uploaded for soft_present()
+static GLuint    fbo;
+
+// Function definitions
+
+uint32_t toByte(float f)
+{
+    return (uint32_t) CLAMP(f * 255.0f + 0.5f, 0.0f, 255.0f);
+}
+
+/* Tint is 8.8 fixed point. Rounds like the 8 bit blend of the GPU, to within
+ * one step. */
+uint32_t blendPixel(uint32_t src, uint32_t dst, const uint32_t tint[3])
+{
+    uint32_t a   = src >> 24;
+    uint32_t out = ALPHA;
+    for (int i = 0; i < 3; i++) {
+        uint32_t s = ((src >> (i * 8) & 0xff) * tint[i]) >> 8;
+        uint32_t d = dst >> (i * 8) & 0xff;
+        uint32_t x = s * a + d * (255 - a) + 128;
+        out |= ((x + (x >> 8)) >> 8) << (i * 8);
+    }
+    return out;
+}
+
+void drawRow(uint32_t* dst, const uint32_t* texels, const int* cols, int count, const uint32_t tint[3],
+        bool isWhite)
+{
+    int x = 0;
+#if defined(__AVX2__)
+    const __m256i zero   = _mm256_setzero_si256();
+    const __m256i alpha  = _mm256_set1_epi32((int) ALPHA);
+    const __m256i opaque = _mm256_set1_epi32(0xff);
+    const __m256i max    = _mm256_set1_epi16(255);
+    const __m256i round  = _mm256_set1_epi16(128);
+    const __m256i tints  = _mm256_setr_epi16((short) tint[0], (short) tint[1], (short) tint[2], 256,
+            (short) tint[0], (short) tint[1], (short) tint[2], 256,
+            (short) tint[0], (short) tint[1], (short) tint[2], 256,
+            (short) tint[0], (short) tint[1], (short) tint[2], 256);
+
+    for (; x + 8 <= count; x += 8) {
+        __m256i idx = _mm256_loadu_si256((const __m256i*) (cols + x));
+        __m256i src = _mm256_i32gather_epi32((const int*) texels, idx, 4);
+        __m256i a   = _mm256_srli_epi32(src, 24);
+        if ((unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi32(a, zero)) == 0xffffffff) continue;
+        if (isWhite && (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi32(a, opaque)) == 0xffffffff) {
+            _mm256_storeu_si256((__m256i*) (dst + x), src);
+            continue;
+        }
+
+        // As for SSE2, the unpacks and pack work within each 128 bit half
+        __m256i d = _mm256_loadu_si256((const __m256i*) (dst + x));
+        __m256i out[2];
+        for (int h = 0; h < 2; h++) {
+            __m256i s16 = h ? _mm256_unpackhi_epi8(src, zero) : _mm256_unpacklo_epi8(src, zero);
+            __m256i d16 = h ? _mm256_unpackhi_epi8(d, zero) : _mm256_unpacklo_epi8(d, zero);
+            s16 = _mm256_srli_epi16(_mm256_mullo_epi16(s16, tints), 8);
+
+            __m256i a16 = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)),
+                    _MM_SHUFFLE(3, 3, 3, 3));
+            __m256i x16 = _mm256_add_epi16(_mm256_mullo_epi16(s16, a16),
+                    _mm256_mullo_epi16(d16, _mm256_sub_epi16(max, a16)));
+            x16    = _mm256_add_epi16(x16, round);
+            out[h] = _mm256_srli_epi16(_mm256_add_epi16(x16, _mm256_srli_epi16(x16, 8)), 8);
+        }
+        _mm256_storeu_si256((__m256i*) (dst + x),
+                _mm256_or_si256(_mm256_packus_epi16(out[0], out[1]), alpha));
+    }
+#elif defined(__SSE2__)
+    const __m128i zero   = _mm_setzero_si128();
+    const __m128i alpha  = _mm_set1_epi32((int) ALPHA);
+    const __m128i opaque = _mm_set1_epi32(0xff);
+    const __m128i max    = _mm_set1_epi16(255);
+    const __m128i round  = _mm_set1_epi16(128);
+    const __m128i tints  = _mm_setr_epi16((short) tint[0], (short) tint[1], (short) tint[2], 256,
+            (short) tint[0], (short) tint[1], (short) tint[2], 256);
+
+    for (; x + 4 <= count; x += 4) {
+        __m128i src = _mm_setr_epi32((int) texels[cols[x]], (int) texels[cols[x + 1]],
+                (int) texels[cols[x + 2]], (int) texels[cols[x + 3]]);
+        __m128i a   = _mm_srli_epi32(src, 24);
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(a, zero)) == 0xffff) continue;
+        if (isWhite && _mm_movemask_epi8(_mm_cmpeq_epi32(a, opaque)) == 0xffff) {
+            _mm_storeu_si128((__m128i*) (dst + x), src);
+            continue;
+        }
+
+        // Two pixels in each half, a channel in each 16 bit lane
+        __m128i d     = _mm_loadu_si128((const __m128i*) (dst + x));
+        __m128i out[2];
+        for (int h = 0; h < 2; h++) {
+            __m128i s16 = h ? _mm_unpackhi_epi8(src, zero) : _mm_unpacklo_epi8(src, zero);
+            __m128i d16 = h ? _mm_unpackhi_epi8(d, zero) : _mm_unpacklo_epi8(d, zero);
+            s16 = _mm_srli_epi16(_mm_mullo_epi16(s16, tints), 8);
+
+            __m128i a16 = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s16, _MM_SHUFFLE(3, 3, 3, 3)),
+                    _MM_SHUFFLE(3, 3, 3, 3));
+            __m128i x16 = _mm_add_epi16(_mm_mullo_epi16(s16, a16),
+                    _mm_mullo_epi16(d16, _mm_sub_epi16(max, a16)));
+            x16    = _mm_add_epi16(x16, round);
+            out[h] = _mm_srli_epi16(_mm_add_epi16(x16, _mm_srli_epi16(x16, 8)), 8);
+        }
+        _mm_storeu_si128((__m128i*) (dst + x), _mm_or_si128(_mm_packus_epi16(out[0], out[1]), alpha));
+    }
+#endif
+
+    for (; x < count; x++) {
+        uint32_t src = texels[cols[x]];
+        uint32_t a   = src >> 24;
+        if (a == 0) continue;
+        dst[x] = a == 255 && isWhite ? src : blendPixel(src, dst[x], tint);
+    }
+}
+
+/* Pixels are covered when their centre is inside the sprite, with the far
+ * edges inclusive like the shader's corners, and take the nearest texel. */
+void drawInstance(const Tex* tex, const Instance* inst)
+{
+    float x0 = inst->pos.x;
+    float y0 = inst->pos.y;
+    float x1 = x0 + MAX(inst->size.x - 1.0f, 0.0f);
+    float y1 = y0 + MAX(inst->size.y - 1.0f, 0.0f);
+    if (x1 <= x0 || y1 <= y0) return;
+
+    int ix0 = MAX((int) ceilf(x0 - 0.5f), 0);
+    int iy0 = MAX((int) ceilf(y0 - 0.5f), 0);
+    int ix1 = MIN((int) ceilf(x1 - 0.5f), SCR_WIDTH);
+    int iy1 = MIN((int) ceilf(y1 - 0.5f), SCR_HEIGHT);
+    if (ix0 >= ix1 || iy0 >= iy1) return;
+
+    int   tw     = (int) tex->size.x;
+    int   th     = (int) tex->size.y;
+    int   layers = (int) (tex->bytes / ((size_t) tw * th * sizeof(uint32_t)));
+    int   layer  = CLAMP((int) floorf(inst->layer + 0.5f), 0, layers - 1);
+    float du     = (inst->uv.z - inst->uv.x) / (x1 - x0);
+    float dv     = (inst->uv.w - inst->uv.y) / (y1 - y0);
+
+    for (int x = ix0; x < ix1; x++) {
+        float u = inst->uv.x + (x + 0.5f - x0) * du;
+        cols[x - ix0] = CLAMP((int) floorf(u * tw), 0, tw - 1);
+    }
+
+    uint32_t tint[3] = {
+        (uint32_t) CLAMP(inst->col.r * 256.0f + 0.5f, 0.0f, 256.0f),
+        (uint32_t) CLAMP(inst->col.g * 256.0f + 0.5f, 0.0f, 256.0f),
+        (uint32_t) CLAMP(inst->col.b * 256.0f + 0.5f, 0.0f, 256.0f)
+    };
+    bool isWhite = tint[0] == 256 && tint[1] == 256 && tint[2] == 256;
+
+    const uint32_t* texels = tex->pixels + (size_t) tw * th * layer;
+    for (int y = iy0; y < iy1; y++) {
+        float v   = inst->uv.y + (y + 0.5f - y0) * dv;
+        int   row = CLAMP((int) floorf(v * th), 0, th - 1);
+        drawRow(pixels + (size_t) y * SCR_WIDTH + ix0, texels + (size_t) row * tw, cols, ix1 - ix0, tint,
+                isWhite);
+    }
+}
+
+void soft_init(void)
+{
+    pixels = (uint32_t*) malloc(sizeof(uint32_t) * SCR_WIDTH * SCR_HEIGHT);
+    cols   = (int*) malloc(sizeof(int) * SCR_WIDTH);
+    if (!pixels || !cols) main_term(EXIT_FAILURE, "Could not allocate the software framebuffer.\n");
+
+    glGenTextures(1, &screen);
+    glBindTexture(GL_TEXTURE_2D, screen);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, SCR_WIDTH, SCR_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+
+    GLint draw;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, screen, 0);
+    if (glCheckFramebufferStatus(GL_READ_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        main_term(EXIT_FAILURE, "Could not create the software framebuffer.\n");
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, draw);
+}
+
+void soft_term(void)
+{
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &screen);
+    free(cols);
+    free(pixels);
+}
+
+void soft_clear(vec3s col)
+{
+    uint32_t p = toByte(col.r) | toByte(col.g) << 8 | toByte(col.b) << 16 | ALPHA;
+    for (size_t i = 0; i < (size_t) SCR_WIDTH * SCR_HEIGHT; i++) {
+        pixels[i] = p;
+    }
+}
+
+void soft_draw(const Tex* tex, const Instance* inst, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        drawInstance(tex, &inst[i]);
+    }
+}
+
+// Flipped on the way, the framebuffer's top row is GL's last
+void soft_present(void)
+{
+    glBindTexture(GL_TEXTURE_2D, screen);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, SCR_WIDTH, SCR_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+    GLint draw;
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &draw);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+    glBlitFramebuffer(0, 0, SCR_WIDTH, SCR_HEIGHT, 0, SCR_HEIGHT, SCR_WIDTH, 0, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, draw);
+}
+
+const uint32_t* soft_getPixels(void)
+{
+    return pixels;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <cglm/struct.h> // vec3s
+#include <stdint.h>      // uint32_t
+#include <stdlib.h>      // size_t
+
+#include "sprite.h"
+#include "tex.h"
+
+// Function prototypes
+void            soft_init(void);
+void            soft_term(void);
+void            soft_clear(vec3s col);
+void            soft_draw(const Tex* tex, const Instance* inst, size_t count);
+void            soft_present(void);
+const uint32_t* soft_getPixels(void);
@@ -1,29 +1,99 @@
 #include <cglm/struct.h> // vec2s, glms_vec2_add
 #include <math.h>        // INFINITY, fmaxf, fminf
+#if defined(__AVX2__)
+#include <immintrin.h>   // _mm256_*
+#elif defined(__SSE2__)
+#include <emmintrin.h>   // _mm_*
+#endif
 
+#include "../collider.h"
 #include "sprite.h"
 
+// Macros
+// Vector operations for the batched swept AABB, LANES targets at a time
+#if defined(__AVX2__)
+#define LANES             8
+typedef __m256  Vecf;
+typedef __m256i Veci;
+#define VEC_SET(x)        _mm256_set1_ps(x)
+#define VEC_SETI(x)       _mm256_set1_epi32(x)
+#define VEC_INDICES()     _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7)
+#define VEC_LOAD(p)       _mm256_loadu_ps(p)
+#define VEC_ADD(a, b)     _mm256_add_ps(a, b)
+#define VEC_SUB(a, b)     _mm256_sub_ps(a, b)
+#define VEC_DIV(a, b)     _mm256_div_ps(a, b)
+#define VEC_MAX(a, b)     _mm256_max_ps(a, b)
+#define VEC_MIN(a, b)     _mm256_min_ps(a, b)
+#define VEC_LT(a, b)      _mm256_cmp_ps(a, b, _CMP_LT_OQ)
+#define VEC_GT(a, b)      _mm256_cmp_ps(a, b, _CMP_GT_OQ)
+#define VEC_AND(a, b)     _mm256_and_ps(a, b)
+#define VEC_OR(a, b)      _mm256_or_ps(a, b)
+#define VEC_SELECT(m, a, b) _mm256_blendv_ps(b, a, m)
+#define VEC_SELECTI(m, a, b) \
+    _mm256_blendv_epi8(b, a, _mm256_castps_si256(m))
+#define VEC_ADDI(a, b)    _mm256_add_epi32(a, b)
+#define VEC_STORE(p, a)   _mm256_storeu_ps(p, a)
+#define VEC_STOREI(p, a)  _mm256_storeu_si256((__m256i*) (p), a)
+#elif defined(__SSE2__)
+#define LANES             4
+typedef __m128  Vecf;
+typedef __m128i Veci;
+#define VEC_SET(x)        _mm_set1_ps(x)
+#define VEC_SETI(x)       _mm_set1_epi32(x)
+#define VEC_INDICES()     _mm_setr_epi32(0, 1, 2, 3)
+#define VEC_LOAD(p)       _mm_loadu_ps(p)
+#define VEC_ADD(a, b)     _mm_add_ps(a, b)
+#define VEC_SUB(a, b)     _mm_sub_ps(a, b)
+#define VEC_DIV(a, b)     _mm_div_ps(a, b)
+#define VEC_MAX(a, b)     _mm_max_ps(a, b)
+#define VEC_MIN(a, b)     _mm_min_ps(a, b)
+#define VEC_LT(a, b)      _mm_cmplt_ps(a, b)
+#define VEC_GT(a, b)      _mm_cmpgt_ps(a, b)
+#define VEC_AND(a, b)     _mm_and_ps(a, b)
+#define VEC_OR(a, b)      _mm_or_ps(a, b)
+#define VEC_SELECT(m, a, b) _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b))
+#define VEC_SELECTI(m, a, b) _mm_or_si128( \
+    _mm_and_si128(_mm_castps_si128(m), a), _mm_andnot_si128(_mm_castps_si128(m), b))
+#define VEC_ADDI(a, b)    _mm_add_epi32(a, b)
+#define VEC_STORE(p, a)   _mm_storeu_ps(p, a)
+#define VEC_STOREI(p, a)  _mm_storeu_si128((__m128i*) (p), a)
+#endif
+
 // Function definitions
 
-Sprite sprite_create(vec2s pos, vec2s size, vec2s texOff, vec2s texSize)
+// uv is the top left and bottom right texture coordinates, see sprite_uv()
+Sprite sprite_create(vec2s pos, vec2s size, vec4s uv, float layer)
 {
     Sprite s;
 
-    s.size = size;
+    s.size  = size;
+    s.layer = layer;
     sprite_setPos(&s, pos);
 
-    // Normalise tex offset
+    s.verts[0].texCoord = (vec2s) {{ uv.x, uv.y }};
+    s.verts[1].texCoord = (vec2s) {{ uv.z, uv.y }};
+    s.verts[2].texCoord = (vec2s) {{ uv.z, uv.w }};
+    s.verts[3].texCoord = (vec2s) {{ uv.x, uv.w }};
+    sprite_setCol(&s, (vec3s) {{ 1.0f, 1.0f, 1.0f }});
+
+    return s;
+}
+
+// Normalise tex offset, top left and bottom right texture coordinates
+vec4s sprite_uv(vec2s size, vec2s texOff, vec2s texSize)
+{
     float u1 = texOff.x / texSize.s;
     float v1 = texOff.y / texSize.t;
     float u2 = (texOff.x + size.s - 1) / texSize.s;
     float v2 = (texOff.y + size.y - 1) / texSize.t;
+    return (vec4s) {{ u1, v1, u2, v2 }};
+}
 
-    s.verts[0].texCoord = (vec2s) {{ u1, v1 }};
-    s.verts[1].texCoord = (vec2s) {{ u2, v1 }};
-    s.verts[2].texCoord = (vec2s) {{ u2, v2 }};
-    s.verts[3].texCoord = (vec2s) {{ u1, v2 }};
-
-    return s;
+Instance sprite_toInstance(const Sprite* s)
+{
+    vec2s uv1 = s->verts[0].texCoord;
+    vec2s uv2 = s->verts[2].texCoord;
+    return (Instance) { s->pos, s->size, {{ uv1.x, uv1.y, uv2.x, uv2.y }}, s->layer, s->col };
 }
 
 void sprite_setPos(Sprite* s, vec2s pos)
@@ -39,6 +109,12 @@ void sprite_setPos(Sprite* s, vec2s pos)
     s->verts[3].pos = (vec2s) {{ x1, y2 }};
 }
 
+// Tint the sprite, it is multiplied with the texture
+void sprite_setCol(Sprite* s, vec3s col)
+{
+    s->col = col;
+}
+
 void sprite_posAdd(Sprite* s, vec2s v)
 {
     for (size_t i = 0; i < VERT_COUNT; i++) {
@@ -111,69 +187,121 @@ bool sprite_checkCollisionEx(Sprite a, Sprite b, vec2s* normal)
 // occurred.
 float sprite_sweptAABB(Sprite moving, vec2s movement, Sprite target, vec2s* normal)
 {
-    float xInvEntry, yInvEntry; float xInvExit, yInvExit;
-    if (movement.x > 0.0f) {
-        xInvEntry = target.pos.x - (moving.pos.x + moving.size.s);
-        xInvExit  = (target.pos.x + target.size.s) - moving.pos.x;
-    } else {
-        xInvEntry = (target.pos.x + target.size.s) - moving.pos.x;
-        xInvExit  = target.pos.x - (moving.pos.x + moving.size.s);
-    }
+    Box a = { moving.pos, glms_vec2_add(moving.pos, moving.size) };
+    Box b = { target.pos, glms_vec2_add(target.pos, target.size) };
+    return collider_sweepBox(&a, movement, &b, normal);
+}
 
-    if (movement.y > 0.0f) {
-        yInvEntry = target.pos.y - (moving.pos.y + moving.size.t);
-        yInvExit  = (target.pos.y + target.size.t) - moving.pos.y;
-    } else {
-        yInvEntry = (target.pos.y + target.size.t) - moving.pos.y;
-        yInvExit  = target.pos.y - (moving.pos.y + moving.size.t);
-    }
+/* Batched swept AABB: one moving box against packed targets, LANES targets
+ * at a time with a scalar fallback. Returns the index of the earliest hit or
+ * -1 if there is none. Ties go to the lowest index, as when looping over
+ * sprite_sweptAABB keeping the first strictly earlier hit, and the winner's
+ * time and normal come from the scalar test so they are bit-identical. */
+int sprite_sweptAABBBatch(const Box* moving, vec2s movement, Boxes targets, float* time, vec2s* normal)
+{
+    float  best = 1.0f;
+    int    hit  = -1;
+    size_t i    = 0;
 
-    float xEntry, yEntry;
-    float xExit,  yExit;
+#ifdef LANES
+    // The direction of movement is the same for every target
+    Vecf left   = VEC_SET(moving->min.x);
+    Vecf right  = VEC_SET(moving->max.x);
+    Vecf top    = VEC_SET(moving->min.y);
+    Vecf bottom = VEC_SET(moving->max.y);
+    Vecf moveX  = VEC_SET(movement.x);
+    Vecf moveY  = VEC_SET(movement.y);
+    Vecf zero   = VEC_SET(0.0f);
+    Vecf one    = VEC_SET(1.0f);
+    Vecf inf    = VEC_SET(INFINITY);
+    Vecf negInf = VEC_SET(-INFINITY);
 
-    if (movement.x == 0.0f) {
-        xEntry = -INFINITY;
-        xExit  = INFINITY;
-    } else {
-        xEntry = xInvEntry / movement.x;
-        xExit  = xInvExit / movement.x;
+    Vecf bestTimes = one;
+    Veci bestHits  = VEC_SETI(-1);
+    Veci indices   = VEC_INDICES();
+    Veci step      = VEC_SETI(LANES);
+
+    for (; i + LANES <= targets.count; i += LANES) {
+        Vecf x1 = VEC_LOAD(targets.x + i);
+        Vecf y1 = VEC_LOAD(targets.y + i);
+        Vecf x2 = VEC_ADD(x1, VEC_LOAD(targets.w + i));
+        Vecf y2 = VEC_ADD(y1, VEC_LOAD(targets.h + i));
+
+        Vecf xInvEntry, yInvEntry, xInvExit, yInvExit;
+        if (movement.x > 0.0f) {
+            xInvEntry = VEC_SUB(x1, right);
+            xInvExit  = VEC_SUB(x2, left);
+        } else {
+            xInvEntry = VEC_SUB(x2, left);
+            xInvExit  = VEC_SUB(x1, right);
+        }
+        if (movement.y > 0.0f) {
+            yInvEntry = VEC_SUB(y1, bottom);
+            yInvExit  = VEC_SUB(y2, top);
+        } else {
+            yInvEntry = VEC_SUB(y2, top);
+            yInvExit  = VEC_SUB(y1, bottom);
+        }
+
+        Vecf xEntry = negInf, xExit = inf;
+        Vecf yEntry = negInf, yExit = inf;
+        if (movement.x != 0.0f) {
+            xEntry = VEC_DIV(xInvEntry, moveX);
+            xExit  = VEC_DIV(xInvExit,  moveX);
+        }
+        if (movement.y != 0.0f) {
+            yEntry = VEC_DIV(yInvEntry, moveY);
+            yExit  = VEC_DIV(yInvExit,  moveY);
+        }
+
+        // Operands swapped to keep the first argument on a tie, like fmaxf/fminf
+        Vecf entryTime = VEC_MAX(yEntry, xEntry);
+        Vecf exitTime  = VEC_MIN(yExit,  xExit);
+
+        Vecf miss = VEC_OR(VEC_GT(entryTime, exitTime),
+                VEC_AND(VEC_LT(xEntry, zero), VEC_LT(yEntry, zero)));
+        miss = VEC_OR(miss, VEC_GT(entryTime, one));
+        Vecf times = VEC_SELECT(miss, one, entryTime);
+
+        // Keep the earliest hit in each lane
+        Vecf isEarlier = VEC_LT(times, bestTimes);
+        bestTimes = VEC_SELECT(isEarlier, times, bestTimes);
+        bestHits  = VEC_SELECTI(isEarlier, indices, bestHits);
+        indices   = VEC_ADDI(indices, step);
     }
 
-    if (movement.y == 0.0f) {
-        yEntry = -INFINITY;
-        yExit  = INFINITY;
-    } else {
-        yEntry = yInvEntry / movement.y;
-        yExit  = yInvExit / movement.y;
+    // Earliest across the lanes, lowest index on a tie
+    float laneTimes[LANES];
+    int   laneHits[LANES];
+    VEC_STORE(laneTimes, bestTimes);
+    VEC_STOREI(laneHits, bestHits);
+    for (size_t l = 0; l < LANES; l++) {
+        if (laneHits[l] < 0) continue;
+        if (laneTimes[l] < best || (laneTimes[l] == best && laneHits[l] < hit)) {
+            best = laneTimes[l];
+            hit  = laneHits[l];
+        }
     }
+#endif // LANES
 
-    float entryTime = fmaxf(xEntry, yEntry);
-    float exitTime  = fminf(xExit, yExit);
+    // Remaining targets one at a time
+    for (; i < targets.count; i++) {
+        vec2s n;
+        float t = collider_sweepBox(moving, movement, &(Box) { {{ targets.x[i], targets.y[i] }},
+                {{ targets.x[i] + targets.w[i], targets.y[i] + targets.h[i] }} }, &n);
+        if (t < best) {
+            best = t;
+            hit  = (int) i;
+        }
+    }
 
-    // No collision if there is no overlap during the movement
-    if (entryTime > exitTime || (xEntry < 0.0f && yEntry < 0.0f) || entryTime > 1.0f) {
-        normal->x = 0.0f;
-        normal->y = 0.0f;
-        return 1.0f;
+    if (hit < 0) {
+        *time   = 1.0f;
+        *normal = (vec2s) {{ 0.0f, 0.0f }};
     } else {
-        // Determine the collision normal based on which axis had the later entry
-        if (xEntry > yEntry) {
-            if (xInvEntry < 0.0f) {
-                normal->x = 1.0f;
-                normal->y = 0.0f;
-            } else {
-                normal->x = -1.0f;
-                normal->y = 0.0f;
-            }
-        } else {
-            if (yInvEntry < 0.0f) {
-                normal->x = 0.0f;
-                normal->y = 1.0f;
-            } else {
-                normal->x = 0.0f;
-                normal->y = -1.0f;
-            }
-        }
-        return entryTime;
+        *time = collider_sweepBox(moving, movement, &(Box) { {{ targets.x[hit], targets.y[hit] }},
+                {{ targets.x[hit] + targets.w[hit], targets.y[hit] + targets.h[hit] }} }, normal);
     }
+
+    return hit;
 }
@@ -1,11 +1,12 @@
 #pragma once
 
-#include <cglm/struct.h> // vec2s
+#include <cglm/struct.h> // vec2s, vec3s, vec4s
 #include <stdlib.h>      // size_t
 
+#include "../collider.h"
+
 // Constants
-constexpr size_t IND_COUNT  = 2;  // Number of indices per vertex
-constexpr size_t VERT_COUNT = 4;  // Number of vertices per sprite
+constexpr size_t VERT_COUNT = 4;  // Number of corners per sprite
 
 // Types
 
@@ -14,6 +15,15 @@ typedef struct {
     vec2s texCoord;
 } Vert;
 
+// One sprite for the instanced renderer, the corners are made in the shader
+typedef struct {
+    vec2s pos;
+    vec2s size;
+    vec4s uv;    // Texture coordinates of the top left and bottom right corners
+    float layer; // Of the texture array
+    vec3s col;   // Tint, white for none
+} Instance;
+
 typedef struct {
     // First vetex is also the position of the sprite
     union
@@ -22,13 +32,28 @@ typedef struct {
 	Vert verts[VERT_COUNT];
     };
     vec2s size;
+    float layer; // Of the texture array
+    vec3s col;   // Tint, white for none
 } Sprite;
 
+// Target boxes packed as a structure of arrays for batched collision tests
+typedef struct {
+    const float* x;
+    const float* y;
+    const float* w;
+    const float* h;
+    size_t       count;
+} Boxes;
+
 // Function prototypes
-Sprite sprite_create(vec2s pos, vec2s size, vec2s texOff, vec2s texSize);
-void   sprite_setPos(Sprite* s, vec2s pos);
-void   sprite_posAdd(Sprite* s, vec2s v);
-void   sprite_texOffAdd(Sprite* s, vec2s v);
-bool   sprite_checkCollision(Sprite a, Sprite b);
-bool   sprite_checkCollisionEx(Sprite a, Sprite b, vec2s* normal);
-float  sprite_sweptAABB(Sprite moving, vec2s movement, Sprite target, vec2s* normal);
+Sprite   sprite_create(vec2s pos, vec2s size, vec4s uv, float layer);
+vec4s    sprite_uv(vec2s size, vec2s texOff, vec2s texSize);
+Instance sprite_toInstance(const Sprite* s);
+void     sprite_setPos(Sprite* s, vec2s pos);
+void     sprite_setCol(Sprite* s, vec3s col);
+void     sprite_posAdd(Sprite* s, vec2s v);
+void     sprite_texOffAdd(Sprite* s, vec2s v);
+bool     sprite_checkCollision(Sprite a, Sprite b);
+bool     sprite_checkCollisionEx(Sprite a, Sprite b, vec2s* normal);
+float    sprite_sweptAABB(Sprite moving, vec2s movement, Sprite target, vec2s* normal);
+int      sprite_sweptAABBBatch(const Box* moving, vec2s movement, Boxes targets, float* time, vec2s* normal);
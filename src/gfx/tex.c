@@ -1,53 +1,252 @@
+/*
+ * Textures are kept at 8 bits a channel with only the channels the image
+ * has, an opaque image drops its alpha. Building with TEX_COMPRESS has the
+ * driver compress loaded images on upload instead, RGTC for grey images and
+ * S3TC for colour where the driver has it. The video memory of every texture
+ * is added to a running total.
+ *
+ * Built with SOFT_REND, textures are kept in memory as RGBA for soft.c and
+ * never uploaded.
+ */
+
 #undef  GLAD_GL_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
 
 #include <cglm/struct.h>   // vec2s
 #include <glad.h>          // gl*, GL*
 #include <stb/stb_image.h> // stbi_load, stbi_image_free
+#include <stdint.h>        // uint32_t
+#include <string.h>        // strcmp
 
 #include "../main.h"
+#include "gfx.h"
 #include "tex.h"
 
+// Types
+typedef struct {
+    GLint  internalFormat;
+    GLint  compressed;     // Used for TEX_COMPRESS, 0 for none
+    GLenum format;
+} Format;
+
+// Function prototypes
+#ifdef SOFT_REND
+static void   toRgba(uint32_t* dst, size_t stride, GLsizei width, GLsizei height, GLenum format,
+        const unsigned char* src);
+#else
+static void   setSwizzle(GLenum format);
+static size_t getBytes(GLsizei layers);
+#endif
+#ifdef TEX_COMPRESS
+static bool   hasS3tc(void);
+#endif
+
+// Constants
+#ifdef TEX_COMPRESS
+// EXT_texture_compression_s3tc, glad is generated without it
+constexpr GLint COMPRESSED_RGB_S3TC_DXT1  = 0x83F0;
+constexpr GLint COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3;
+#endif
+static const Format FORMATS[] = // By channel count
+{
+    {},
+    { GL_R8,    GL_COMPRESSED_RED_RGTC1, GL_RED  }, // Grey
+    { GL_RG8,   GL_COMPRESSED_RG_RGTC2,  GL_RG   }, // Grey and alpha
+    { GL_RGB8,  0,                       GL_RGB  },
+    { GL_RGBA8, 0,                       GL_RGBA }
+};
+static const Format OPAQUE = { GL_RGB8, 0, GL_RGBA }; // RGBA data with the alpha dropped
+
 // Variables
 int unit = 0;
+static size_t total;
 
 // Function definitions
 
-Tex tex_create(GLint internalFormat, GLsizei width, GLsizei height, GLenum format, const void* data)
+#ifndef SOFT_REND
+
+// Grey images are read as grey rather than red
+void setSwizzle(GLenum format)
+{
+    GLint swizzle[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+    if (format == GL_RG) {
+        swizzle[3] = GL_GREEN;
+    } else if (format != GL_RED) {
+        return;
+    }
+    glTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
+}
+
+// Ask the driver rather than work it out, so compression is counted right
+size_t getBytes(GLsizei layers)
+{
+    GLint isCompressed;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_COMPRESSED, &isCompressed);
+    if (isCompressed) {
+        GLint size;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+        return (size_t) size;
+    }
+
+    static const GLenum CHANNELS[] =
+    {
+        GL_TEXTURE_RED_SIZE, GL_TEXTURE_GREEN_SIZE, GL_TEXTURE_BLUE_SIZE, GL_TEXTURE_ALPHA_SIZE
+    };
+    GLint width, height, bits = 0;
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_WIDTH, &width);
+    glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, GL_TEXTURE_HEIGHT, &height);
+    for (size_t i = 0; i < sizeof(CHANNELS) / sizeof(CHANNELS[0]); i++) {
+        GLint size;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D_ARRAY, 0, CHANNELS[i], &size);
+        bits += size;
+    }
+    return (size_t) width * height * layers * bits / 8;
+}
+
+#else
+
+// Unpack into RGBA rows stride pixels apart, grey as grey like setSwizzle()
+void toRgba(uint32_t* dst, size_t stride, GLsizei width, GLsizei height, GLenum format,
+        const unsigned char* src)
 {
+    int chan = format == GL_RED ? 1 : format == GL_RG ? 2 : format == GL_RGB ? 3 : 4;
+    for (GLsizei y = 0; y < height; y++) {
+        for (GLsizei x = 0; x < width; x++, src += chan) {
+            uint32_t r = src[0];
+            uint32_t g = chan >= 3 ? src[1] : r;
+            uint32_t b = chan >= 3 ? src[2] : r;
+            uint32_t a = chan == 4 ? src[3] : chan == 2 ? src[1] : 255;
+            dst[y * stride + x] = r | g << 8 | b << 16 | a << 24;
+        }
+    }
+}
+
+#endif // SOFT_REND
+
+#ifdef TEX_COMPRESS
+bool hasS3tc(void)
+{
+    static int has = -1;
+    if (has < 0) {
+        GLint count;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+        has = 0;
+        for (GLint i = 0; i < count && !has; i++) {
+            has = strcmp((const char*) glGetStringi(GL_EXTENSIONS, i), "GL_EXT_texture_compression_s3tc") == 0;
+        }
+    }
+    return has;
+}
+#endif
+
+
+// Every texture is an array, a single image is an array of one layer
+Tex tex_create(GLint internalFormat, GLsizei width, GLsizei height, GLsizei layers, GLenum format,
+        const void* data)
+{
+#ifdef SOFT_REND
+    (void) internalFormat;
+    size_t    bytes  = (size_t) width * height * layers * sizeof(uint32_t);
+    uint32_t* pixels = (uint32_t*) calloc(1, bytes);
+    if (!pixels) main_term(EXIT_FAILURE, "Could not allocate a texture.\n");
+    if (data) toRgba(pixels, width, width, height * layers, format, data);
+    total += bytes;
+
+    return (Tex) {
+        .unit   = unit++,
+        .size   = (vec2s) {{ (float) width, (float) height }},
+        .bytes  = bytes,
+        .pixels = pixels
+    };
+#else
     GLuint name;
     glGenTextures(1, &name);
-    glActiveTexture(GL_TEXTURE0 + unit);
-    glBindTexture(GL_TEXTURE_2D, name);
+    gfx_bindTex(unit, name);
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    setSwizzle(format);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    // Rows of grey and RGB images aren't padded to 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layers, 0, format, GL_UNSIGNED_BYTE,
+            data);
 
-    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, width, height, 0, format, GL_UNSIGNED_BYTE, data);
+    size_t bytes = getBytes(layers);
+    total += bytes;
 
     return (Tex) {
-        .name = name,
-        .unit = unit++,
-        .size = (vec2s) {{ (float) width, (float) height }}
+        .name  = name,
+        .unit  = unit++,
+        .size  = (vec2s) {{ (float) width, (float) height }},
+        .bytes = bytes
     };
+#endif
 }
 
 Tex tex_load(const char* file)
 {
     int width, height, chan;
-    void* data = stbi_load(file, &width, &height, &chan, 0);
+    unsigned char* data = stbi_load(file, &width, &height, &chan, 0);
     if (!data) main_term(EXIT_FAILURE, "Could not texload image %s\n.", file);
 
-    Tex tex = tex_create(GL_RGBA32F, width, height, GL_RGBA, data);
+    bool isOpaque = chan == 4 && tex_isOpaque(data, (size_t) width * height);
+    Tex  tex      = tex_create(tex_getFormat(chan, isOpaque), width, height, 1, FORMATS[chan].format, data);
 
     stbi_image_free(data);
 
     return tex;
 }
 
+/* Internal format for an image of chan channels, the alpha is dropped if it is
+ * opaque and with TEX_COMPRESS it is compressed where the driver can. Images
+ * made into an array by the caller pick it the same way as tex_load(). */
+GLint tex_getFormat(int chan, bool isOpaque)
+{
+    Format f = chan == 4 && isOpaque ? OPAQUE : FORMATS[chan];
+#ifdef TEX_COMPRESS
+    if (f.internalFormat == GL_RGB8 && hasS3tc()) f.compressed = COMPRESSED_RGB_S3TC_DXT1;
+    if (f.internalFormat == GL_RGBA8 && hasS3tc()) f.compressed = COMPRESSED_RGBA_S3TC_DXT5;
+    if (f.compressed) f.internalFormat = f.compressed;
+#endif
+    return f.internalFormat;
+}
+
+bool tex_isOpaque(const unsigned char* rgba, size_t count)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (rgba[i * 4 + 3] != 255) return false;
+    }
+    return true;
+}
+
+// Fill the top left of a layer
+void tex_setLayer(Tex tex, GLint layer, GLsizei width, GLsizei height, GLenum format, const void* data)
+{
+#ifdef SOFT_REND
+    size_t stride = (size_t) tex.size.x;
+    toRgba(tex.pixels + stride * (size_t) tex.size.y * layer, stride, width, height, format, data);
+#else
+    gfx_bindTex(tex.unit, tex.name);
+    glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, height, 1, format, GL_UNSIGNED_BYTE, data);
+#endif
+}
+
 void tex_unload(Tex tex)
 {
+#ifdef SOFT_REND
+    free(tex.pixels);
+#else
+    gfx_bindTex(tex.unit, 0); // So the tracker doesn't take a reused name as bound
     glDeleteTextures(1, &tex.name);
+#endif
+    total -= tex.bytes;
+}
+
+// Video memory taken by all the textures
+size_t tex_getTotal(void)
+{
+    return total;
 }
@@ -3,15 +3,24 @@
 
 #include <cglm/struct.h> // vec2s
 #include <glad.h>        // GL*
+#include <stdint.h>      // uint32_t
+#include <stdlib.h>      // size_t
 
 // Types
 typedef struct {
     GLuint name;
     GLenum unit;
     vec2s  size;
+    size_t bytes; // Video memory taken
+    uint32_t* pixels; // RGBA layers for the software renderer, SOFT_REND only
 } Tex;
 
 // Function prototypes
-Tex  tex_create(GLint internalFormat, GLsizei width, GLsizei height, GLenum format, const void* data);
-Tex  tex_load(const char* file);
-void tex_unload(Tex tex);
+Tex    tex_create(GLint internalFormat, GLsizei width, GLsizei height, GLsizei layers, GLenum format,
+        const void* data);
+Tex    tex_load(const char* file);
+GLint  tex_getFormat(int chan, bool isOpaque);
+bool   tex_isOpaque(const unsigned char* rgba, size_t count);
+void   tex_setLayer(Tex tex, GLint layer, GLsizei width, GLsizei height, GLenum format, const void* data);
+void   tex_unload(Tex tex);
+size_t tex_getTotal(void);
@@ -0,0 +1,184 @@
+/*
+ * Time spent drawing each pass of a frame. Each pass is bracketed by a
+ * GL_TIME_ELAPSED query. The queries are read back FRAMES frames later, when
+ * the GPU is done with them, so reading never stalls. Where the driver has no
+ * timer, the passes are timed on the CPU instead, which only covers
+ * submitting the draws. The times are averaged over AVERAGE frames. A pass
+ * with a query dropped in a frame takes no sample from that frame, each pass
+ * is averaged over its own samples.
+ *
+ * SOFT_REND builds always time on the CPU, where the drawing is done.
+ *
+ * The passes are timed on the render thread, the means can be read from any.
+ *
+ * Nothing is timed until timer_init(), which gfx_init() calls.
+ */
+
+#undef GLAD_GL_IMPLEMENTATION
+
+#include <glad.h>    // gl*, GL*
+#include <pthread.h> // pthread_mutex_*
+#include <stdint.h>  // uint64_t
+#include <time.h>    // clock_gettime, CLOCK_MONOTONIC
+
+#include "timer.h"
+
+// Function prototypes
+static double getSeconds(void);
+
+// Constants
+constexpr int    FRAMES    = 4;  // Frames of queries in flight
+constexpr int    QUERY_MAX = 16; // Queries per frame, passes past this aren't timed
+constexpr int    AVERAGE   = 60; // Frames averaged over
+constexpr size_t NO_PASS   = TIMER_PASSES;
+
+// Variables
+static bool            isEnabled;
+static bool            isGpu;
+static GLuint          queries[FRAMES][QUERY_MAX];
+static size_t          passes[FRAMES][QUERY_MAX]; // Pass timed by each query
+static int             used[FRAMES];
+static int             frame;                     // Of the ring of queries
+static size_t          current = NO_PASS;         // Pass being timed
+static double          start;                     // CPU time the pass began
+static bool            isIssued[FRAMES];          // Holds a whole frame of queries
+static double          frameSums[TIMER_PASSES];   // Seconds in the frame being read
+static double          sums[TIMER_PASSES];        // Seconds over the frames averaged so far
+static int             counts[TIMER_PASSES];      // Frames sampled of those
+static int             frameCount;
+static Timings         timings;
+static pthread_mutex_t timingsMutex = PTHREAD_MUTEX_INITIALIZER; // Guards timings and the session
+static double          sessionSums[TIMER_PASSES];
+static long            sessionCounts[TIMER_PASSES];
+
+// Function definitions
+
+double getSeconds(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+void timer_init(void)
+{
+    if (isEnabled) return;
+    isEnabled = true;
+
+#ifdef SOFT_REND
+    isGpu = false;
+#else
+    GLint bits;
+    glGetQueryiv(GL_TIME_ELAPSED, GL_QUERY_COUNTER_BITS, &bits);
+    isGpu = bits > 0;
+#endif
+    if (isGpu) glGenQueries(FRAMES * QUERY_MAX, &queries[0][0]);
+    timings.isGpu = isGpu;
+}
+
+void timer_term(void)
+{
+    if (isEnabled && isGpu) glDeleteQueries(FRAMES * QUERY_MAX, &queries[0][0]);
+    isEnabled = false;
+}
+
+// Passes can't nest, only one query can be running
+void timer_begin(size_t pass)
+{
+    if (!isEnabled || pass >= TIMER_PASSES) return;
+
+    if (isGpu) {
+        if (used[frame] == QUERY_MAX) return;
+        int i = used[frame]++;
+        passes[frame][i] = pass;
+        glBeginQuery(GL_TIME_ELAPSED, queries[frame][i]);
+    } else {
+        start = getSeconds();
+    }
+    current = pass;
+}
+
+void timer_end(void)
+{
+    if (current == NO_PASS) return;
+
+    if (isGpu) {
+        glEndQuery(GL_TIME_ELAPSED);
+    } else {
+        frameSums[current] += getSeconds() - start;
+    }
+    current = NO_PASS;
+}
+
+/* Move on to the oldest frame of queries and take its results. One still not
+ * ready is dropped rather than waited for, and with it the pass's sample for
+ * the frame. A pass not drawn in a frame is a sample of zero. */
+void timer_endFrame(void)
+{
+    if (!isEnabled) return;
+
+    bool isSampled = true;
+    bool isDropped[TIMER_PASSES] = {};
+    if (isGpu) {
+        isIssued[frame] = true;
+        frame     = (frame + 1) % FRAMES;
+        isSampled = isIssued[frame];
+        for (int i = 0; i < used[frame]; i++) {
+            size_t pass = passes[frame][i];
+            GLint  isReady;
+            glGetQueryObjectiv(queries[frame][i], GL_QUERY_RESULT_AVAILABLE, &isReady);
+            if (!isReady) {
+                isDropped[pass] = true;
+                continue;
+            }
+
+            uint64_t ns;
+            glGetQueryObjectui64v(queries[frame][i], GL_QUERY_RESULT, &ns);
+            frameSums[pass] += ns * 1e-9;
+        }
+        used[frame] = 0;
+    }
+
+    // The session takes every frame, so a run shorter than AVERAGE counts too
+    pthread_mutex_lock(&timingsMutex);
+    for (size_t i = 0; i < TIMER_PASSES; i++) {
+        if (isSampled && !isDropped[i]) {
+            sums[i]          += frameSums[i];
+            counts[i]++;
+            sessionSums[i]   += frameSums[i];
+            sessionCounts[i]++;
+        }
+        frameSums[i] = 0.0;
+    }
+
+    if (++frameCount == AVERAGE) {
+        for (size_t i = 0; i < TIMER_PASSES; i++) {
+            if (counts[i]) timings.ms[i] = sums[i] / counts[i] * 1000.0;
+            sums[i]   = 0.0;
+            counts[i] = 0;
+        }
+        frameCount = 0;
+    }
+    pthread_mutex_unlock(&timingsMutex);
+}
+
+// Means over the last AVERAGE frames
+Timings timer_get(void)
+{
+    pthread_mutex_lock(&timingsMutex);
+    Timings t = timings;
+    pthread_mutex_unlock(&timingsMutex);
+    return t;
+}
+
+// Means over every frame sampled since timer_init()
+Timings timer_getSession(void)
+{
+    pthread_mutex_lock(&timingsMutex);
+    Timings t = { .isGpu = isGpu };
+    for (size_t i = 0; i < TIMER_PASSES; i++) {
+        t.ms[i] = sessionCounts[i] ? sessionSums[i] / sessionCounts[i] * 1000.0 : 0.0;
+    }
+    pthread_mutex_unlock(&timingsMutex);
+    return t;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <stdlib.h> // size_t
+
+// Constants
+constexpr size_t TIMER_PASSES = 8; // Passes a frame can be split into
+
+// Types
+typedef struct {
+    double ms[TIMER_PASSES]; // Mean per frame
+    bool   isGpu;            // Else the time spent submitting on the CPU
+} Timings;
+
+// Function prototypes
+void    timer_init(void);
+void    timer_term(void);
+void    timer_begin(size_t pass);
+void    timer_end(void);
+void    timer_endFrame(void);
+Timings timer_get(void);
+Timings timer_getSession(void);
@@ -0,0 +1,131 @@
+/*
+ * A small pool of worker threads for splitting a loop across cores.
+ * job_parallelFor() hands each worker, and the calling thread, one slice of
+ * the range and returns when they have all finished.
+ */
+
+#include <pthread.h> // pthread_*
+#include <stdint.h>  // intptr_t
+#include <stdio.h>   // fprintf
+#include <unistd.h>  // sysconf
+
+#include "job.h"
+
+// Function prototypes
+static int   getCoreCount(void);
+static void  runSlice(void (*func)(int first, int last), int count, int slice);
+static void* worker(void* arg);
+
+// Constants
+constexpr int MAX_WORKERS = 15;
+
+// Variables
+static pthread_t       workers[MAX_WORKERS];
+static int             workerCount = 0;
+static pthread_mutex_t mutex       = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  startCond   = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  doneCond    = PTHREAD_COND_INITIALIZER;
+static void          (*job)(int first, int last);
+static int             jobCount;
+static unsigned        generation  = 0; // Incremented for each new job
+static int             pending     = 0; // Workers still running the job
+static bool            isQuit      = false;
+
+// Function definitions
+
+int getCoreCount(void)
+{
+#ifdef _SC_NPROCESSORS_ONLN
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int) n : 1;
+#else
+    return 4;
+#endif
+}
+
+// Slice 0 is run by the calling thread, the workers are 1 onwards
+void runSlice(void (*func)(int first, int last), int count, int slice)
+{
+    int slices = workerCount + 1;
+    int first  = count * slice / slices;
+    int last   = count * (slice + 1) / slices;
+    if (first < last) func(first, last);
+}
+
+void* worker(void* arg)
+{
+    int      slice = (int) (intptr_t) arg;
+    unsigned seen  = 0;
+
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+	while (generation == seen && !isQuit) pthread_cond_wait(&startCond, &mutex);
+	if (isQuit) break;
+
+	seen = generation;
+	void (*func)(int, int) = job;
+	int count = jobCount;
+	pthread_mutex_unlock(&mutex);
+
+	runSlice(func, count, slice);
+
+	pthread_mutex_lock(&mutex);
+	if (--pending == 0) pthread_cond_signal(&doneCond);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    return nullptr;
+}
+
+void job_init(void)
+{
+    int count = getCoreCount() - 1;
+    if (count > MAX_WORKERS) count = MAX_WORKERS;
+
+    for (int i = 0; i < count; i++) {
+	if (pthread_create(&workers[i], nullptr, worker, (void*) (intptr_t) (i + 1)) != 0) {
+	    fprintf(stderr, "Unable to create worker thread, using %i.\n", i);
+	    break;
+	}
+	workerCount++;
+    }
+}
+
+void job_term(void)
+{
+    pthread_mutex_lock(&mutex);
+    isQuit = true;
+    pthread_cond_broadcast(&startCond);
+    pthread_mutex_unlock(&mutex);
+
+    for (int i = 0; i < workerCount; i++) pthread_join(workers[i], nullptr);
+    workerCount = 0;
+}
+
+int job_getWorkerCount(void)
+{
+    return workerCount;
+}
+
+// Run func over 0 to count - 1 split across the workers, blocks until done
+void job_parallelFor(int count, void (*func)(int first, int last))
+{
+    if (workerCount == 0) {
+	func(0, count);
+	return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    job      = func;
+    jobCount = count;
+    pending  = workerCount;
+    generation++;
+    pthread_cond_broadcast(&startCond);
+    pthread_mutex_unlock(&mutex);
+
+    runSlice(func, count, 0);
+
+    pthread_mutex_lock(&mutex);
+    while (pending > 0) pthread_cond_wait(&doneCond, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
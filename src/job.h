@@ -0,0 +1,7 @@
+#pragma once
+
+// Function prototypes
+void job_init(void);
+void job_term(void);
+int  job_getWorkerCount(void);
+void job_parallelFor(int count, void (*func)(int first, int last));
@@ -5,10 +5,12 @@
 #include <glad.h>        // gl*
 #include <GLFW/glfw3.h>  // glfw*, GLFW*
 #include <stdarg.h>      // va_list, va_start, va_end
-#include <stdio.h>       // fprintf, vfprintf
-#include <stdlib.h>      // exit, atexit, EXIT_SUCCESS, EXIT_FAILURE
+#include <stdio.h>       // fprintf, vfprintf, printf
+#include <stdlib.h>      // exit, atexit, atoi, atof, EXIT_SUCCESS, EXIT_FAILURE
+#include <string.h>      // strcmp
 
 #include "main.h"
+#include "render.h"
 #include "game/asset.h"
 #include "game/draw.h"
 #include "game/game.h"
@@ -17,12 +19,15 @@
 
 // Function prototypes
 static void errorCallback(int err, const char* desc);
-static void init(void);
+static void init(bool isHeadless);
 static void cursorPosCallback(GLFWwindow* window, double xpos, double ypos);
 static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 static void mouseCallback(GLFWwindow* window, int button, int action, int mods);
 static void resizeCallback(GLFWwindow* window, int width, int height);
+static void hintContext(void);
 static void createWindow(void);
+static void createHeadless(void);
+static void benchmark(int frames);
 
 // Constants
 static const char     TITLE[]        = "Break Bricks";
@@ -33,6 +38,9 @@ static const unsigned SCR_GREEN_BITS = 8;
 static const unsigned SCR_BLUE_BITS  = 8;
 static const unsigned OPENGL_MAJOR   = 3;
 static const unsigned OPENGL_MINOR   = 3;
+static const char     BENCH_ARG[]    = "--bench";  // Followed by the number of frames
+static const double   BENCH_STEP     = 1.0 / 60.0; // Game time per benchmark frame
+static const char     TICK_ARG[]     = "--tick-rate"; // Followed by the simulation steps per second
 
 // Variables
 static GLFWwindow* window      = nullptr;
@@ -46,15 +54,17 @@ void errorCallback(int err, const char* desc)
     fprintf(stderr, "%i: %s\n", err, desc);
 }
 
-void init(void)
+void init(bool isHeadless)
 {
     glfwSetErrorCallback(errorCallback);
+    if (isHeadless) glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
 
     if (!glfwInit()) exit(EXIT_FAILURE);
 }
 
 void main_term(int status, const char* fmt, ...)
 {
+    render_stop();
     if (window) glfwDestroyWindow(window);
 
     glfwTerminate();
@@ -142,11 +152,11 @@ void resizeCallback([[maybe_unused]] GLFWwindow* window, int width, int height)
 	game_pause();
     } else {
 	isMinimised = false;
-	gfx_resize(width, height);
+	render_resize(width, height);
     }
 }
 
-void createWindow(void)
+void hintContext(void)
 {
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, OPENGL_MAJOR);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, OPENGL_MINOR);
@@ -155,6 +165,11 @@ void createWindow(void)
 #ifndef NDEBUG
     glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
 #endif // !NDEBUG
+}
+
+void createWindow(void)
+{
+    hintContext();
 
     GLFWmonitor* mon = glfwGetPrimaryMonitor();
     const GLFWvidmode* mode = glfwGetVideoMode(mon);
@@ -191,17 +206,92 @@ void createWindow(void)
     glfwSwapInterval(1);
 }
 
-int main(void)
+/* For machines with no display or GPU: GLFW's null platform with an OSMesa
+ * context, or EGL where there is no OSMesa, both of which Mesa's llvmpipe
+ * runs. The window is never shown, drawing goes to an offscreen framebuffer. */
+void createHeadless(void)
+{
+    hintContext();
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+    if (!(window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, TITLE, nullptr, nullptr))) {
+	glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+	if (!(window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, TITLE, nullptr, nullptr))) {
+	    main_term(EXIT_FAILURE, "Failed to create a headless context.\n");
+	}
+    }
+
+    glfwMakeContextCurrent(window);
+    int ver = gladLoadGL(glfwGetProcAddress);
+    if (!ver) main_term(EXIT_FAILURE, "Failed to load OpenGL.\n");
+}
+
+/* Run the game with the ball kept in play for a number of frames, drawing
+ * each with draw_frame(), and report the frame and pass times. Each frame
+ * waits for the GPU so its work is counted. */
+void benchmark(int frames)
 {
-    init();
+    asset_loading();
+    gfx_initOffscreen();
+    asset_load();
+    game_loaded();
+
+    double total = 0.0, fastest = 0.0, slowest = 0.0;
+    for (int i = 0; i < frames; i++) {
+	double start = glfwGetTime();
+	game_click(); // Start, release the ball and start again when lost
+	game_update(BENCH_STEP);
+	draw_frame();
+	render_frame();
+	glFinish();
+
+	double time = glfwGetTime() - start;
+	total  += time;
+	fastest = i == 0 || time < fastest ? time : fastest;
+	slowest = time > slowest ? time : slowest;
+    }
+
+    printf("%s\n", (const char*) glGetString(GL_RENDERER));
+    printf("%i frames, mean %.3f ms, fastest %.3f ms, slowest %.3f ms\n", frames, total / frames * 1000.0,
+	    fastest * 1000.0, slowest * 1000.0);
+    main_term(EXIT_SUCCESS, nullptr);
+}
+
+int main(int argc, char* argv[])
+{
+    int frames = 0;
+    for (int i = 1; i < argc; i++) {
+	bool isBench = strcmp(argv[i], BENCH_ARG) == 0;
+	bool isTick  = strcmp(argv[i], TICK_ARG) == 0;
+	if (!isBench && !isTick) main_term(EXIT_FAILURE, "Unknown option %s.\n", argv[i]);
+	if (i + 1 == argc) main_term(EXIT_FAILURE, "%s needs a value.\n", argv[i]);
+
+	const char* value = argv[++i];
+	if (isBench) {
+	    frames = atoi(value);
+	    if (frames <= 0) main_term(EXIT_FAILURE, "The number of frames must be above zero.\n");
+	} else {
+	    double rate = atof(value);
+	    if (rate <= 0.0) main_term(EXIT_FAILURE, "The tick rate must be above zero.\n");
+	    game_setTickRate(rate);
+	}
+    }
+
+    init(frames > 0);
+    if (frames > 0) {
+	createHeadless();
+	benchmark(frames);
+    }
     createWindow();
 
     // Render one frame: the loading screen
     asset_loading();
     draw_frame();
+    render_frame();
     glfwSwapBuffers(window);
     // Render to both buffers to avoid flicker
     draw_frame();
+    render_frame();
     glfwSwapBuffers(window);
 
     asset_load();
@@ -209,6 +299,7 @@ int main(void)
     // Ignore events that happened during loading
     glfwPollEvents();
     game_loaded();
+    render_start(window);
 
     double last_time = glfwGetTime();
     while (!glfwWindowShouldClose(window))
@@ -224,7 +315,7 @@ int main(void)
 	    input_update();
 	    game_update(frameTime);
 	    draw_frame();
-	    glfwSwapBuffers(window);
+	    render_frame();
 	}
     }
 
@@ -0,0 +1,161 @@
+/*
+ * The render thread. Once started it owns the GL context: it takes each frame
+ * queued by the game, draws it and swaps, while the game goes on to update
+ * the next. Frames pass between them through the render queue without
+ * locking. The game waits for each frame to be taken before it updates
+ * again, so it stays one frame ahead and none are dropped, and the time the
+ * render thread spends blocked in a swap is time the game can use.
+ *
+ * Anything else for GL, a resize or screenshot, is handed over with the next
+ * frame. Until render_start() frames are drawn by the calling thread.
+ */
+
+#define GLFW_INCLUDE_NONE
+
+#include <GLFW/glfw3.h> // glfw*, GLFWwindow
+#include <pthread.h>    // pthread_*
+#include <stdlib.h>     // EXIT_FAILURE
+
+#include "main.h"
+#include "render.h"
+#include "gfx/gfx.h"
+#include "gfx/queue.h"
+
+// Function prototypes
+static void  drawFrame(void);
+static void* run(void* arg);
+
+// Variables
+static GLFWwindow*     window;
+static pthread_t       thread;
+static bool            isRunning    = false;
+static pthread_mutex_t mutex        = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  queuedCond   = PTHREAD_COND_INITIALIZER; // A frame was published
+static pthread_cond_t  takenCond    = PTHREAD_COND_INITIALIZER; // The render thread took it
+static bool            isQuit       = false;
+static int             resizeWidth  = 0; // Size to apply before the next frame, none if 0
+static int             resizeHeight = 0;
+#ifndef NDEBUG
+static bool            isScreenshot = false;
+#endif
+
+// Function definitions
+
+void drawFrame(void)
+{
+    queue_draw();
+    gfx_endFrame();
+}
+
+void* run([[maybe_unused]] void* arg)
+{
+    glfwMakeContextCurrent(window);
+
+    pthread_mutex_lock(&mutex);
+    for (;;) {
+	while (!queue_isPending() && !isQuit) pthread_cond_wait(&queuedCond, &mutex);
+	if (isQuit) break;
+
+	queue_take();
+	int width  = resizeWidth;
+	int height = resizeHeight;
+	resizeWidth = resizeHeight = 0;
+#ifndef NDEBUG
+	bool isShot  = isScreenshot;
+	isScreenshot = false;
+#endif
+	pthread_cond_signal(&takenCond);
+	pthread_mutex_unlock(&mutex);
+
+	if (width) gfx_resize(width, height);
+	drawFrame();
+#ifndef NDEBUG
+	if (isShot) gfx_screenshot();
+#endif
+	glfwSwapBuffers(window);
+
+	pthread_mutex_lock(&mutex);
+    }
+    pthread_mutex_unlock(&mutex);
+
+    glfwMakeContextCurrent(nullptr);
+    return nullptr;
+}
+
+// Hand the context of w over to a new render thread
+void render_start(GLFWwindow* w)
+{
+    window = w;
+    glfwMakeContextCurrent(nullptr);
+    if (pthread_create(&thread, nullptr, run, nullptr) != 0) {
+	glfwMakeContextCurrent(window);
+	main_term(EXIT_FAILURE, "Unable to create the render thread.\n");
+    }
+    isRunning = true;
+}
+
+/* Wait for the frame being drawn and take the context back. On the render
+ * thread itself, after a failure there, it only stops the loop. */
+void render_stop(void)
+{
+    if (!isRunning) return;
+    isRunning = false;
+
+    pthread_mutex_lock(&mutex);
+    isQuit = true;
+    pthread_cond_broadcast(&queuedCond);
+    pthread_cond_broadcast(&takenCond);
+    pthread_mutex_unlock(&mutex);
+
+    if (pthread_equal(pthread_self(), thread)) return;
+    pthread_join(thread, nullptr);
+    glfwMakeContextCurrent(window);
+}
+
+/* Publish the frame queued by draw_frame() and wait until the render thread
+ * takes it, not until it's drawn. Before render_start() the frame is drawn
+ * here and the caller swaps. */
+void render_frame(void)
+{
+    queue_publish();
+    if (!isRunning) {
+	queue_take();
+	drawFrame();
+	return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    pthread_cond_signal(&queuedCond);
+    while (queue_isPending() && !isQuit) pthread_cond_wait(&takenCond, &mutex);
+    pthread_mutex_unlock(&mutex);
+}
+
+void render_resize(int width, int height)
+{
+    if (!isRunning) {
+	gfx_resize(width, height);
+	return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    resizeWidth  = width;
+    resizeHeight = height;
+    pthread_mutex_unlock(&mutex);
+}
+
+#ifndef NDEBUG
+
+// Of the next frame drawn
+void render_screenshot(void)
+{
+    if (!isRunning) {
+	gfx_screenshot();
+	return;
+    }
+
+    pthread_mutex_lock(&mutex);
+    isScreenshot = true;
+    pthread_mutex_unlock(&mutex);
+}
+
+#endif // !NDEBUG
@@ -0,0 +1,14 @@
+#pragma once
+
+#define GLFW_INCLUDE_NONE
+
+#include <GLFW/glfw3.h> // GLFWwindow
+
+// Function prototypes
+void render_start(GLFWwindow* window);
+void render_stop(void);
+void render_frame(void);
+void render_resize(int width, int height);
+#ifndef NDEBUG
+void render_screenshot(void);
+#endif
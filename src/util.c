@@ -1,15 +1,24 @@
-#include <math.h>   // roundf
+#include <stdint.h> // uint32_t
 #include <stdio.h>  // FILE, f*, stderr, perror, malloc, free
-#include <stdlib.h> // size_t, srand
+#include <stdlib.h> // size_t
 #include <time.h>   // timespec*
 
 #include "util.h"
 
+// Function prototypes
+static uint32_t randomNext(void);
+
 // Constants
 const char READ_ONLY_TEXT[]  = "r";
 const char READ_ONLY_BIN[]   = "rb";
 const char WRITE_ONLY_TEXT[] = "w";
 const char WRITE_ONLY_BIN[]  = "wb";
+#ifdef FIXED_PHYSICS
+static const uint32_t SEED   = 0x2545f491; // Same sequence every run
+#endif
+
+// Variables
+static uint32_t randomState = 1;
 
 // Function definitions
 
@@ -61,13 +70,26 @@ void util_unload(char* data)
 // Decent random seed: https://stackoverflow.com/q/58150771
 void util_randomSeed(void)
 {
+#ifdef FIXED_PHYSICS
+    randomState = SEED;
+#else
     struct timespec ts;
     timespec_get(&ts, TIME_UTC);
-    srand(ts.tv_nsec);
+    randomState = (uint32_t) ts.tv_nsec | 1; // xorshift state must not be zero
+#endif
+}
+
+// xorshift32, unlike rand() the sequence is the same on every platform
+uint32_t randomNext(void)
+{
+    randomState ^= randomState << 13;
+    randomState ^= randomState >> 17;
+    randomState ^= randomState << 5;
+    return randomState;
 }
 
 // Random number between min and max, closed interval
 int util_randomInt(int min, int max)
 {
-    return roundf(min + ((float) rand()) / RAND_MAX * (max - min));
+    return min + (int) (randomNext() % (uint32_t) (max - min + 1));
 }
@@ -0,0 +1,171 @@
+/*
+ * Checks sprite_sweptAABBBatch() against a loop over the scalar
+ * sprite_sweptAABB(), the hit, time and normal must be bit-identical. Run
+ * with make test, which builds it with the same flags as the game so the
+ * SIMD path tested is the one the game uses.
+ */
+
+#include <cglm/struct.h> // vec2s, vec4s, glms_vec2_add
+#include <stdint.h>      // uint32_t
+#include <stdio.h>       // printf
+#include <stdlib.h>      // size_t, EXIT_SUCCESS, EXIT_FAILURE
+#include <string.h>      // memcmp
+
+#include "../src/collider.h"
+#include "../src/gfx/sprite.h"
+
+// Function prototypes
+static uint32_t next(void);
+static float    randomCoord(void);
+static void     check(vec2s pos, vec2s size, vec2s movement, size_t count, const char* name);
+static void     checkEdges(void);
+static void     checkRandom(void);
+
+// Constants
+constexpr size_t MAX_TARGETS = 37; // Covers a full batch of either width and a tail
+constexpr int    RANDOM_RUNS = 100000;
+
+// Variables
+static uint32_t seed     = 12345;
+static float    xs[MAX_TARGETS], ys[MAX_TARGETS], ws[MAX_TARGETS], hs[MAX_TARGETS];
+static int      failures = 0;
+static int      cases    = 0;
+
+// Function definitions
+
+// Xorshift, so every run and machine tests the same cases
+uint32_t next(void)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+// On a coarse grid half the time, so edges touch and times tie
+float randomCoord(void)
+{
+    if (next() & 1) return (float) (next() % 16) * 8.0f;
+    return (float) (next() % 12800) / 100.0f;
+}
+
+// The moving box against the first count targets in xs, ys, ws and hs
+void check(vec2s pos, vec2s size, vec2s movement, size_t count, const char* name)
+{
+    Box    moving  = { pos, glms_vec2_add(pos, size) };
+    Sprite movingS = sprite_create(pos, size, (vec4s) {}, 0.0f);
+
+    float expTime   = 1.0f;
+    vec2s expNormal = {{ 0.0f, 0.0f }};
+    int   expHit    = -1;
+    for (size_t i = 0; i < count; i++) {
+	Sprite target = sprite_create((vec2s) {{ xs[i], ys[i] }}, (vec2s) {{ ws[i], hs[i] }}, (vec4s) {}, 0.0f);
+	vec2s  n;
+	float  t = sprite_sweptAABB(movingS, movement, target, &n);
+	if (t < expTime) {
+	    expTime   = t;
+	    expNormal = n;
+	    expHit    = (int) i;
+	}
+    }
+
+    float time;
+    vec2s normal;
+    int   hit = sprite_sweptAABBBatch(&moving, movement, (Boxes) { xs, ys, ws, hs, count }, &time, &normal);
+
+    cases++;
+    if (hit != expHit || memcmp(&time, &expTime, sizeof time) != 0 || memcmp(&normal, &expNormal, sizeof normal) != 0) {
+	if (failures++ < 10) {
+	    printf("%s: hit %i time %a normal %a %a, scalar hit %i time %a normal %a %a\n", name, hit, time,
+		    normal.x, normal.y, expHit, expTime, expNormal.x, expNormal.y);
+	}
+    }
+}
+
+void checkEdges(void)
+{
+    vec2s size = {{ 16.0f, 16.0f }};
+
+    // A row of identical bricks above, every one hit at once
+    for (size_t i = 0; i < MAX_TARGETS; i++) {
+	xs[i] = 0.0f;
+	ys[i] = -32.0f;
+	ws[i] = 128.0f;
+	hs[i] = 32.0f;
+    }
+    for (size_t n = 0; n <= MAX_TARGETS; n++) {
+	check((vec2s) {{ 8.0f, 8.0f }}, size, (vec2s) {{ 3.0f, -16.0f }}, n, "tie");
+    }
+
+    // Side by side bricks with the same entry time, straight and diagonal
+    for (size_t i = 0; i < MAX_TARGETS; i++) {
+	xs[i] = (float) i * 8.0f;
+	ys[i] = -32.0f;
+	ws[i] = 8.0f;
+	hs[i] = 32.0f;
+    }
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ 0.0f, -16.0f }}, MAX_TARGETS, "row");
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ 8.0f, -8.0f }}, MAX_TARGETS, "row diagonal");
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ -8.0f, -8.0f }}, MAX_TARGETS, "row diagonal back");
+
+    // Zero velocity, in one axis, both and negative zero
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ 0.0f, 0.0f }}, MAX_TARGETS, "still");
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ -0.0f, -0.0f }}, MAX_TARGETS, "still negative");
+    check((vec2s) {{ 40.0f, 8.0f }}, size, (vec2s) {{ -0.0f, -12.0f }}, MAX_TARGETS, "negative zero x");
+    check((vec2s) {{ 40.0f, -4.0f }}, size, (vec2s) {{ 12.0f, 0.0f }}, MAX_TARGETS, "zero y");
+
+    // Touching, entry time zero, moving in, along and away
+    check((vec2s) {{ 40.0f, 0.0f }}, size, (vec2s) {{ 0.0f, -4.0f }}, MAX_TARGETS, "touch in");
+    check((vec2s) {{ 40.0f, 0.0f }}, size, (vec2s) {{ 4.0f, 0.0f }}, MAX_TARGETS, "touch along");
+    check((vec2s) {{ 40.0f, 0.0f }}, size, (vec2s) {{ 0.0f, 4.0f }}, MAX_TARGETS, "touch away");
+
+    // Grazing the corner of the last brick, entry equal to exit
+    float right = xs[MAX_TARGETS - 1] + ws[MAX_TARGETS - 1];
+    check((vec2s) {{ right, 8.0f }}, size, (vec2s) {{ -8.0f, -8.0f }}, MAX_TARGETS, "corner");
+    check((vec2s) {{ right + 8.0f, 8.0f }}, size, (vec2s) {{ -8.0f, -8.0f }}, MAX_TARGETS, "corner miss");
+}
+
+void checkRandom(void)
+{
+    for (int run = 0; run < RANDOM_RUNS; run++) {
+	size_t count = next() % (MAX_TARGETS + 1);
+	for (size_t i = 0; i < count; i++) {
+	    xs[i] = randomCoord();
+	    ys[i] = randomCoord();
+	    ws[i] = (float) (1 + next() % 4) * 8.0f;
+	    hs[i] = (float) (1 + next() % 4) * 8.0f;
+	}
+
+	vec2s pos  = {{ randomCoord(), randomCoord() }};
+	vec2s size = {{ 16.0f, 16.0f }};
+	vec2s movement;
+	switch (next() % 4) {
+	    case 0:
+		movement = (vec2s) {{ 0.0f, 0.0f }};
+		break;
+	    case 1:
+		movement = (vec2s) {{ (float) (next() % 65) - 32.0f, 0.0f }};
+		break;
+	    case 2:
+		movement = (vec2s) {{ 0.0f, (float) (next() % 65) - 32.0f }};
+		break;
+	    default:
+		movement = (vec2s) {{ randomCoord() - 64.0f, randomCoord() - 64.0f }};
+		break;
+	}
+	check(pos, size, movement, count, "random");
+    }
+}
+
+int main(void)
+{
+    checkEdges();
+    checkRandom();
+
+    if (failures > 0) {
+	printf("sprite_sweptAABBBatch: %i of %i cases differ from sprite_sweptAABB\n", failures, cases);
+	return EXIT_FAILURE;
+    }
+    printf("sprite_sweptAABBBatch: %i cases match sprite_sweptAABB\n", cases);
+    return EXIT_SUCCESS;
+}